@@ -0,0 +1,281 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiactivityheatmap.h"
+#include "rsiactivityhistory.h"
+
+#include <QEvent>
+#include <QLocale>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QTimer>
+
+#include <algorithm>
+
+static constexpr int DAY = 24 * RSIActivityHistory::HOUR;
+
+// The wall clock may drift this many seconds from the recorded seconds, as
+// ticks and refreshes are not in step, before the cells are placed again.
+static constexpr int MAX_DRIFT = 5;
+
+// Space between the labels and the cells.
+static constexpr int LABEL_SPACING = 4;
+
+// @returns @p time in seconds since the epoch, as if the local time was UTC.
+static qint64 localSeconds(const QDateTime &time)
+{
+    return time.toSecsSinceEpoch() + time.offsetFromUtc();
+}
+
+RSIActivityHeatmap::RSIActivityHeatmap(const RSIActivityHistory &history, QWidget *parent)
+    : QWidget(parent)
+    , m_history(history)
+    , m_refreshTimer(new QTimer(this))
+    , m_currentDateTime([]() {
+        return QDateTime::currentDateTime();
+    })
+{
+    // Cells are filled as seconds are recorded, only the visible map follows.
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &RSIActivityHeatmap::refresh);
+
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    updateColors();
+    setPeriod(Period::Day);
+}
+
+RSIActivityHeatmap::~RSIActivityHeatmap()
+{
+}
+
+void RSIActivityHeatmap::setPeriod(Period period)
+{
+    m_period = period;
+    if (period == Period::Day) {
+        m_rowSeconds = RSIActivityHistory::HOUR;
+        m_cellSeconds = RSIActivityHistory::MINUTE;
+        m_rows = 24;
+        m_labelColumns = 15; // minutes
+    } else {
+        m_rowSeconds = DAY;
+        m_cellSeconds = 15 * RSIActivityHistory::MINUTE;
+        m_rows = 7;
+        m_labelColumns = 6 * 4; // hours
+    }
+    m_columns = m_rowSeconds / m_cellSeconds;
+    static_assert(7 * DAY <= RSIActivityHistory::CAPACITY, "the oldest row has to be recorded");
+
+    updateLayout();
+    updateGeometry();
+    rebuild();
+}
+
+void RSIActivityHeatmap::refresh()
+{
+    const qint64 recorded = m_history.recordedSeconds();
+    if (recorded == m_now) {
+        return;
+    }
+    // A reset empties the rows, a suspend or a clock change moves them.
+    const qint64 shift = localSeconds(m_currentDateTime()) - recorded;
+    if (recorded < m_now || qAbs(shift - m_shift) > MAX_DRIFT) {
+        rebuild();
+        return;
+    }
+
+    // A new row moves all of them up.
+    const qint64 now = recorded + m_shift;
+    if (now / m_rowSeconds != m_row) {
+        rebuild();
+        return;
+    }
+
+    // The cells finished since the last refresh, and the newest one.
+    const qint64 cell = now - now % m_cellSeconds;
+    for (qint64 start = m_cell; start <= cell; start += m_cellSeconds) {
+        updateCell(start);
+    }
+    m_cell = cell;
+    m_now = recorded;
+}
+
+void RSIActivityHeatmap::rebuild()
+{
+    m_now = m_history.recordedSeconds();
+    m_shift = localSeconds(m_currentDateTime()) - m_now;
+    const qint64 now = m_now + m_shift;
+    m_row = now / m_rowSeconds;
+    m_cell = now - now % m_cellSeconds;
+
+    m_image = QImage(m_columns, m_rows, QImage::Format_ARGB32);
+    for (int row = 0; row < m_rows; ++row) {
+        const qint64 rowStart = (m_row - (m_rows - 1 - row)) * m_rowSeconds;
+        QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(row));
+        for (int column = 0; column < m_columns; ++column) {
+            line[column] = cellColor(rowStart + column * m_cellSeconds);
+        }
+    }
+    // The labels move along with the rows.
+    update();
+}
+
+void RSIActivityHeatmap::updateCell(qint64 start)
+{
+    const int row = m_rows - 1 - static_cast<int>(m_row - start / m_rowSeconds);
+    const int column = static_cast<int>(start % m_rowSeconds) / m_cellSeconds;
+    const QRgb color = cellColor(start);
+    if (m_image.pixel(column, row) != color) {
+        m_image.setPixel(column, row, color);
+        update(cellRect(row, column));
+    }
+}
+
+QRgb RSIActivityHeatmap::cellColor(qint64 start) const
+{
+    // The cell in recorded seconds. The first recorded second need not be
+    // at the start of a cell.
+    const qint64 now = m_history.recordedSeconds();
+    const qint64 begin = std::max<qint64>(start - m_shift, 0);
+    const qint64 end = std::min<qint64>(start - m_shift + m_cellSeconds, now);
+    // Nothing recorded yet, the background shows.
+    if (begin >= end) {
+        return 0;
+    }
+    const qint64 active = m_history.activeSeconds(now - begin) - m_history.activeSeconds(now - end);
+    return m_colors[active * 255 / m_cellSeconds];
+}
+
+QRect RSIActivityHeatmap::cellRect(int row, int column) const
+{
+    const int left = m_grid.left() + column * m_grid.width() / m_columns;
+    const int top = m_grid.top() + row * m_grid.height() / m_rows;
+    const int right = m_grid.left() + (column + 1) * m_grid.width() / m_columns;
+    const int bottom = m_grid.top() + (row + 1) * m_grid.height() / m_rows;
+    return QRect(left, top, right - left, bottom - top);
+}
+
+QString RSIActivityHeatmap::rowLabel(qint64 row) const
+{
+    const qint64 start = row * m_rowSeconds;
+    if (m_period == Period::Day) {
+        return QLocale().toString(QTime(start % DAY / RSIActivityHistory::HOUR, 0), QLocale::ShortFormat);
+    }
+    return QLocale().dayName(QDate(1970, 1, 1).addDays(start / DAY).dayOfWeek(), QLocale::ShortFormat);
+}
+
+void RSIActivityHeatmap::updateLayout()
+{
+    // Wide enough for any row, so the cells stay put as the rows move.
+    int labelWidth = 0;
+    for (qint64 row = 0; row < (m_period == Period::Day ? 24 : 7); ++row) {
+        labelWidth = std::max(labelWidth, fontMetrics().horizontalAdvance(rowLabel(row)));
+    }
+    m_grid = rect().adjusted(labelWidth + LABEL_SPACING, 0, 0, -fontMetrics().height());
+}
+
+void RSIActivityHeatmap::updateColors()
+{
+    const QColor idle = palette().color(QPalette::Base);
+    const QColor active = palette().color(QPalette::Highlight);
+    for (int i = 0; i < 256; ++i) {
+        m_colors[i] = qRgb(idle.red() + (active.red() - idle.red()) * i / 255,
+                           idle.green() + (active.green() - idle.green()) * i / 255,
+                           idle.blue() + (active.blue() - idle.blue()) * i / 255);
+    }
+}
+
+QSize RSIActivityHeatmap::sizeHint() const
+{
+    // The labels take what the cells leave.
+    const QSize labels = size() - m_grid.size();
+    return QSize(4 * m_columns, 8 * m_rows) + labels;
+}
+
+QSize RSIActivityHeatmap::minimumSizeHint() const
+{
+    const QSize labels = size() - m_grid.size();
+    return QSize(m_columns, 4 * m_rows) + labels;
+}
+
+void RSIActivityHeatmap::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    painter.fillRect(dirty, palette().color(QPalette::Window));
+
+    // Only the cells under the dirty area are painted, a single one on a
+    // refresh, however large the widget.
+    const QRect cells = dirty.intersected(m_grid).translated(-m_grid.topLeft());
+    if (!cells.isEmpty()) {
+        const int firstColumn = std::clamp(cells.left() * m_columns / std::max(1, m_grid.width()), 0, m_columns - 1);
+        const int lastColumn = std::clamp(cells.right() * m_columns / std::max(1, m_grid.width()), 0, m_columns - 1);
+        const int firstRow = std::clamp(cells.top() * m_rows / std::max(1, m_grid.height()), 0, m_rows - 1);
+        const int lastRow = std::clamp(cells.bottom() * m_rows / std::max(1, m_grid.height()), 0, m_rows - 1);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(m_image.constScanLine(row));
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                if (line[column]) {
+                    painter.fillRect(cellRect(row, column), QColor(line[column]));
+                }
+            }
+        }
+    }
+    if (m_grid.contains(dirty)) {
+        return;
+    }
+
+    // Row labels as often as they fit, on the same rows as they move up.
+    painter.setPen(palette().color(QPalette::WindowText));
+    const int lineHeight = fontMetrics().height();
+    const int rowHeight = std::max(1, m_grid.height() / m_rows);
+    const int rowStep = (lineHeight + rowHeight - 1) / rowHeight;
+    for (int row = 0; row < m_rows; ++row) {
+        const qint64 index = m_row - (m_rows - 1 - row);
+        if (index % rowStep != 0) {
+            continue;
+        }
+        const QRect cell = cellRect(row, 0);
+        const QRect label(0, cell.center().y() - lineHeight / 2, m_grid.left() - LABEL_SPACING, lineHeight);
+        painter.drawText(label, Qt::AlignRight | Qt::AlignVCenter, rowLabel(index));
+    }
+
+    // The minutes or hours the columns start at.
+    for (int column = 0; column < m_columns; column += m_labelColumns) {
+        const int minutes = column * m_cellSeconds / RSIActivityHistory::MINUTE;
+        const QString text = QString::number(m_period == Period::Day ? minutes : minutes / 60);
+        const QRect label(cellRect(0, column).left(), m_grid.bottom() + 1, fontMetrics().horizontalAdvance(text), lineHeight);
+        painter.drawText(label, Qt::AlignLeft | Qt::AlignVCenter, text);
+    }
+}
+
+void RSIActivityHeatmap::showEvent(QShowEvent *)
+{
+    // Nothing was computed while hidden.
+    rebuild();
+    m_refreshTimer->start();
+}
+
+void RSIActivityHeatmap::hideEvent(QHideEvent *)
+{
+    m_refreshTimer->stop();
+}
+
+void RSIActivityHeatmap::resizeEvent(QResizeEvent *)
+{
+    updateLayout();
+}
+
+void RSIActivityHeatmap::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange) {
+        updateColors();
+        rebuild();
+    } else if (event->type() == QEvent::FontChange) {
+        updateLayout();
+        updateGeometry();
+        update();
+    }
+    QWidget::changeEvent(event);
+}
@@ -0,0 +1,129 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIACTIVITYHEATMAP_H
+#define RSIBREAK_RSIACTIVITYHEATMAP_H
+
+#include <QDateTime>
+#include <QImage>
+#include <QWidget>
+#include <array>
+#include <functional>
+
+class QTimer;
+class RSIActivityHistory;
+
+/**
+ * @class RSIActivityHeatmap
+ * Shows the recorded activity as a heatmap, the current row at the bottom.
+ * Over a day every row is an hour and every cell a minute, over a week
+ * every row is a day and every cell a quarter of an hour. The more active
+ * seconds in a cell, the closer its color to the highlight color.
+ *
+ * Rows and cells follow the local clock: the last recorded second is taken
+ * to be the current one, rows start on the hour or at midnight, and are
+ * labelled with their hour or day on the left. The minutes or hours of the
+ * columns are along the bottom.
+ *
+ * The colors are kept in an image with a pixel per cell. While shown, only
+ * the newest cell is computed and repainted every second, the whole image
+ * is only rebuilt when a new row starts or the clock jumps.
+ */
+class RSIActivityHeatmap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum class Period {
+        Day,
+        Week
+    };
+    Q_ENUM(Period)
+
+    explicit RSIActivityHeatmap(const RSIActivityHistory &history, QWidget *parent = nullptr);
+    ~RSIActivityHeatmap() override;
+
+    void setPeriod(Period period);
+    Period period() const
+    {
+        return m_period;
+    }
+
+    /** @returns the colors of the cells, a pixel per cell. */
+    const QImage &image() const
+    {
+        return m_image;
+    }
+
+    /** Brings the cells up to the seconds recorded so far. */
+    void refresh();
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    friend class RSIActivityHeatmapTest;
+
+    // Computes all cells again.
+    void rebuild();
+
+    // Computes the cell starting at local second @p start, and repaints it
+    // if its color changed.
+    void updateCell(qint64 start);
+
+    // @returns the color of the cell starting at local second @p start.
+    QRgb cellColor(qint64 start) const;
+
+    // @returns where the cell in @p row and @p column is painted.
+    QRect cellRect(int row, int column) const;
+
+    // @returns the label of row @p row, counted in rows since the epoch.
+    QString rowLabel(qint64 row) const;
+
+    // Places the cells next to the labels.
+    void updateLayout();
+
+    // Fills m_colors from the palette.
+    void updateColors();
+
+    const RSIActivityHistory &m_history;
+    QTimer *m_refreshTimer;
+    // Replaced by the tests.
+    std::function<QDateTime()> m_currentDateTime;
+
+    Period m_period = Period::Day;
+    int m_rowSeconds;
+    int m_cellSeconds;
+    int m_rows;
+    int m_columns;
+    // Columns between two labels along the bottom.
+    int m_labelColumns;
+
+    // Where the cells are painted, the labels are around it.
+    QRect m_grid;
+
+    // The color of every cell, the oldest row at the top.
+    QImage m_image;
+    // The colors from idle to active, by active 256th of a cell.
+    std::array<QRgb, 256> m_colors;
+
+    // Local seconds since the epoch minus recorded seconds, as of the last
+    // rebuild.
+    qint64 m_shift = 0;
+
+    // The bottom row and the newest cell in local time, and the seconds
+    // recorded at the last refresh.
+    qint64 m_row = -1;
+    qint64 m_cell = -1;
+    qint64 m_now = -1;
+};
+
+#endif // RSIBREAK_RSIACTIVITYHEATMAP_H
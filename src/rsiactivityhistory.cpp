@@ -0,0 +1,114 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiactivityhistory.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+RSIActivityHistory::RSIActivityHistory()
+{
+    reset();
+}
+
+void RSIActivityHistory::reset()
+{
+    m_seconds.fill(0);
+    m_minutes.fill(0);
+    m_hours.fill(0);
+    m_now = 0;
+}
+
+void RSIActivityHistory::record(bool active, qint64 seconds)
+{
+    // Every slot is overwritten alike. Going slot by slot from the middle of
+    // a minute would clear its counter again on the way round.
+    if (seconds >= CAPACITY) {
+        m_now += seconds;
+        m_seconds.fill(active ? ~quint64(0) : 0);
+        m_minutes.fill(active ? MINUTE : 0);
+        m_hours.fill(active ? HOUR : 0);
+
+        // The current minute and hour only hold the seconds up to now.
+        const qint64 slot = m_now % CAPACITY;
+        m_minutes[slot / MINUTE] = active ? slot % MINUTE : 0;
+        m_hours[slot / HOUR] = active ? slot % HOUR : 0;
+        return;
+    }
+
+    while (seconds > 0) {
+        const qint64 slot = m_now % CAPACITY;
+        const int bit = slot % WORD_BITS;
+        const int intoMinute = slot % MINUTE;
+
+        // A chunk stays within one word and one minute.
+        const int n = static_cast<int>(std::min<qint64>({seconds, WORD_BITS - bit, MINUTE - intoMinute}));
+        const quint64 mask = ((quint64(1) << n) - 1) << bit;
+
+        // The counters of a new minute or hour still hold the ones a week ago.
+        if (intoMinute == 0) {
+            m_minutes[slot / MINUTE] = 0;
+            if (slot % HOUR == 0) {
+                m_hours[slot / HOUR] = 0;
+            }
+        }
+
+        if (active) {
+            m_seconds[slot / WORD_BITS] |= mask;
+            m_minutes[slot / MINUTE] += n;
+            m_hours[slot / HOUR] += n;
+        } else {
+            m_seconds[slot / WORD_BITS] &= ~mask;
+        }
+
+        m_now += n;
+        seconds -= n;
+    }
+}
+
+int RSIActivityHistory::countBits(qint64 from, qint64 to) const
+{
+    int count = 0;
+    while (from < to) {
+        const qint64 slot = from % CAPACITY;
+        const int bit = slot % WORD_BITS;
+        const int n = static_cast<int>(std::min<qint64>(to - from, WORD_BITS - bit));
+        const quint64 mask = n == WORD_BITS ? ~quint64(0) : ((quint64(1) << n) - 1) << bit;
+        count += qPopulationCount(m_seconds[slot / WORD_BITS] & mask);
+        from += n;
+    }
+    return count;
+}
+
+qint64 RSIActivityHistory::activeSeconds(qint64 seconds) const
+{
+    seconds = std::min({seconds, m_now, qint64(CAPACITY)});
+    if (seconds <= 0) {
+        return 0;
+    }
+
+    // The minute and hour counters of the current ones only hold the
+    // seconds up to now, so they can be used right up to the end.
+    qint64 pos = m_now - seconds;
+    const qint64 firstMinute = (pos + MINUTE - 1) / MINUTE * MINUTE;
+    qint64 count = countBits(pos, std::min(firstMinute, m_now));
+
+    for (pos = firstMinute; pos < m_now && pos % HOUR != 0; pos += MINUTE) {
+        count += m_minutes[(pos % CAPACITY) / MINUTE];
+    }
+    for (; pos < m_now; pos += HOUR) {
+        count += m_hours[(pos % CAPACITY) / HOUR];
+    }
+    return count;
+}
+
+double RSIActivityHistory::activeFraction(qint64 seconds) const
+{
+    seconds = std::min(seconds, qint64(CAPACITY));
+    if (seconds <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(activeSeconds(seconds)) / static_cast<double>(seconds);
+}
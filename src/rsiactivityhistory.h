@@ -0,0 +1,77 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIACTIVITYHISTORY_H
+#define RSIBREAK_RSIACTIVITYHISTORY_H
+
+#include <QtGlobal>
+#include <array>
+
+/**
+ * @class RSIActivityHistory
+ * Records per second whether the user was active, for the last week, and
+ * answers which part of any recent period the user was active.
+ *
+ * The seconds are kept as bits in 64 bit words, next to the number of active
+ * seconds per minute and per hour. A period is counted with popcount over the
+ * seconds up to its first whole minute, then by minutes up to the first whole
+ * hour and by hours after that, so at most 2 words, 59 minutes and 168 hours
+ * are read whatever its length.
+ */
+class RSIActivityHistory
+{
+public:
+    static constexpr int MINUTE = 60;
+    static constexpr int HOUR = 60 * MINUTE;
+
+    /** The number of seconds kept, older ones are overwritten. */
+    static constexpr int CAPACITY = 7 * 24 * HOUR;
+
+    RSIActivityHistory();
+
+    /** Forgets all recorded seconds. */
+    void reset();
+
+    /**
+     * Records the next @p seconds seconds as active or idle. Whole words are
+     * written at once, so recording a long idle period is cheap.
+     */
+    void record(bool active, qint64 seconds = 1);
+
+    /** @returns the number of seconds recorded since the last reset. */
+    qint64 recordedSeconds() const
+    {
+        return m_now;
+    }
+
+    /**
+     * @returns the number of active seconds in the last @p seconds seconds,
+     * at most CAPACITY of them.
+     */
+    qint64 activeSeconds(qint64 seconds) const;
+
+    /**
+     * @returns the active part of the last @p seconds seconds, between 0 and 1.
+     * Seconds from before the last reset count as idle.
+     */
+    double activeFraction(qint64 seconds) const;
+
+private:
+    static constexpr int WORD_BITS = 64;
+    static_assert(CAPACITY % WORD_BITS == 0 && CAPACITY % HOUR == 0, "the rings have to wrap around together");
+
+    // @returns the active seconds in [from, to), which lie within 64 seconds.
+    int countBits(qint64 from, qint64 to) const;
+
+    // Every second, by its position in the ring, one bit per second.
+    std::array<quint64, CAPACITY / WORD_BITS> m_seconds;
+    // Active seconds per minute and per hour, the current ones so far.
+    std::array<quint8, CAPACITY / MINUTE> m_minutes;
+    std::array<quint16, CAPACITY / HOUR> m_hours;
+
+    // Seconds recorded since the last reset.
+    qint64 m_now = 0;
+};
+
+#endif // RSIBREAK_RSIACTIVITYHISTORY_H
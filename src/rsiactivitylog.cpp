@@ -0,0 +1,243 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiactivitylog.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+
+#include <KCrash>
+
+#include <algorithm>
+#include <cstring>
+
+#include "rsiactivityhistory.h"
+
+static const char MAGIC[8] = {'R', 'S', 'I', 'A', 'C', 'T', 0, 1};
+
+// The log flushed by the KCrash emergency save handler.
+static RSIActivityLog *crashLog = nullptr;
+
+static void emergencySave(int)
+{
+    if (crashLog) {
+        crashLog->flush();
+    }
+}
+
+RSIActivityLog::RSIActivityLog(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+RSIActivityLog::~RSIActivityLog()
+{
+    if (crashLog == this) {
+        KCrash::setEmergencySaveFunction(nullptr);
+        crashLog = nullptr;
+    }
+    QObject::disconnect(m_quitConnection);
+    flush();
+}
+
+QString RSIActivityLog::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/activity");
+}
+
+QString RSIActivityLog::dayPath(const QDate &date) const
+{
+    return m_directory + QLatin1Char('/') + date.toString(Qt::ISODate) + QStringLiteral(".log");
+}
+
+bool RSIActivityLog::isValid(const char *data, qint64 size)
+{
+    return size >= EVENTS_OFFSET && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void RSIActivityLog::record(bool active, qint64 seconds, qint64 end)
+{
+    for (qint64 time = end - seconds; time < end;) {
+        if (time < m_dayStart || time >= m_nextDayStart) {
+            openDay(time);
+        }
+        const qint64 dayEnd = std::min(end, m_nextDayStart);
+
+        if (m_file.isOpen()) {
+            char *bits = m_image.data() + HEADER_SIZE;
+            const int from = time - m_dayStart;
+            const int to = dayEnd - m_dayStart;
+            for (int i = from; i < to; ++i) {
+                if (active) {
+                    bits[i / 8] |= char(1 << (i % 8));
+                } else {
+                    bits[i / 8] &= char(~(1 << (i % 8)));
+                }
+            }
+            m_dirtyFrom = std::min(m_dirtyFrom, HEADER_SIZE + from / 8);
+            m_dirtyTo = std::max(m_dirtyTo, HEADER_SIZE + (to + 7) / 8);
+        }
+        time = dayEnd;
+    }
+
+    if (end - m_lastFlush >= FLUSH_INTERVAL) {
+        flush();
+        m_lastFlush = end;
+    }
+}
+
+void RSIActivityLog::recordEvent(RSIStat stat, qint64 time)
+{
+    if (time < m_dayStart || time >= m_nextDayStart) {
+        openDay(time);
+    }
+    m_pendingEvents.append({time, stat, 0});
+}
+
+void RSIActivityLog::flush()
+{
+    if (!m_file.isOpen()) {
+        m_pendingEvents.clear();
+        return;
+    }
+
+    // Whole pages, the page cache would read in the rest of them otherwise.
+    if (m_dirtyFrom < m_dirtyTo) {
+        const int from = m_dirtyFrom / PAGE_SIZE * PAGE_SIZE;
+        const int to = std::min((m_dirtyTo + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE, EVENTS_OFFSET);
+        if (!m_file.seek(from) || m_file.write(m_image.constData() + from, to - from) != to - from) {
+            qWarning() << "Could not write" << m_file.fileName() << m_file.errorString();
+        }
+        m_dirtyFrom = EVENTS_OFFSET;
+        m_dirtyTo = 0;
+    }
+
+    if (!m_pendingEvents.isEmpty()) {
+        const qint64 size = m_pendingEvents.size() * qint64(sizeof(Event));
+        if (!m_file.seek(m_file.size()) || m_file.write(reinterpret_cast<const char *>(m_pendingEvents.constData()), size) != size) {
+            qWarning() << "Could not write" << m_file.fileName() << m_file.errorString();
+        }
+        m_pendingEvents.clear();
+    }
+
+    // Hands the data to the kernel, which survives a crash of rsibreak.
+    m_file.flush();
+}
+
+void RSIActivityLog::flushOnCrash()
+{
+    crashLog = this;
+    KCrash::setEmergencySaveFunction(emergencySave);
+}
+
+void RSIActivityLog::flushOnQuit()
+{
+    QObject::disconnect(m_quitConnection);
+    m_quitConnection = QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [this]() {
+        flush();
+    });
+}
+
+void RSIActivityLog::openDay(qint64 time)
+{
+    flush();
+    m_file.close();
+
+    const QDate date = QDateTime::fromSecsSinceEpoch(time).date();
+    m_dayStart = date.startOfDay().toSecsSinceEpoch();
+    m_nextDayStart = date.addDays(1).startOfDay().toSecsSinceEpoch();
+
+    // Records for this day are dropped if it cannot be opened.
+    QDir().mkpath(m_directory);
+    m_file.setFileName(dayPath(date));
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Could not open" << m_file.fileName() << m_file.errorString();
+        return;
+    }
+
+    m_image = m_file.read(EVENTS_OFFSET);
+    if (!isValid(m_image.constData(), m_image.size())) {
+        // A new day, or a file which is not a day file: start over.
+        m_image.fill(0, EVENTS_OFFSET);
+        memcpy(m_image.data(), MAGIC, sizeof(MAGIC));
+        memcpy(m_image.data() + sizeof(MAGIC), &m_dayStart, sizeof(m_dayStart));
+        m_file.resize(0);
+        m_file.write(m_image);
+    }
+}
+
+RSIActivityLog::Day::Day(const RSIActivityLog &log, const QDate &date)
+    : m_file(log.dayPath(date))
+    , m_start(date.startOfDay().toSecsSinceEpoch())
+    , m_length(std::min<qint64>(date.addDays(1).startOfDay().toSecsSinceEpoch() - m_start, DAY_SECONDS))
+{
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < EVENTS_OFFSET) {
+        return;
+    }
+    const uchar *data = m_file.map(0, m_file.size());
+    if (data && isValid(reinterpret_cast<const char *>(data), m_file.size())) {
+        m_seconds = data + HEADER_SIZE;
+    }
+}
+
+QVector<RSIActivityLog::Event> RSIActivityLog::Day::events() const
+{
+    QVector<Event> events;
+    if (!m_seconds) {
+        return events;
+    }
+    const qint64 count = (m_file.size() - EVENTS_OFFSET) / qint64(sizeof(Event));
+    events.resize(count);
+    memcpy(events.data(), m_seconds - HEADER_SIZE + EVENTS_OFFSET, count * sizeof(Event));
+    return events;
+}
+
+void RSIActivityLog::replay(RSIActivityHistory &history, qint64 now)
+{
+    flush();
+    history.reset();
+
+    // Seconds go into the history in runs, idle days are a single call.
+    bool runActive = false;
+    qint64 runLength = 0;
+    auto feed = [&](bool active, qint64 seconds) {
+        if (active != runActive && runLength > 0) {
+            history.record(runActive, runLength);
+            runLength = 0;
+        }
+        runActive = active;
+        runLength += seconds;
+    };
+
+    qint64 time = now - RSIActivityHistory::CAPACITY;
+    for (QDate date = QDateTime::fromSecsSinceEpoch(time).date(); time < now; date = date.addDays(1)) {
+        const Day day(*this, date);
+        const qint64 dayEnd = std::min(now, day.start() + day.length());
+        if (!day.isValid()) {
+            feed(false, dayEnd - time);
+            time = dayEnd;
+            continue;
+        }
+
+        const uchar *bits = day.seconds();
+        while (time < dayEnd) {
+            const qint64 i = time - day.start();
+            // Whole bytes when they are all idle or all active.
+            if (i % 8 == 0 && time + 8 <= dayEnd && (bits[i / 8] == 0 || bits[i / 8] == 0xff)) {
+                feed(bits[i / 8] != 0, 8);
+                time += 8;
+            } else {
+                feed(bits[i / 8] & (1 << (i % 8)), 1);
+                ++time;
+            }
+        }
+    }
+
+    if (runLength > 0) {
+        history.record(runActive, runLength);
+    }
+}
@@ -0,0 +1,169 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIACTIVITYLOG_H
+#define RSIBREAK_RSIACTIVITYLOG_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QFile>
+#include <QMetaObject>
+#include <QVector>
+
+#include "rsiglobals.h"
+
+class RSIActivityHistory;
+
+/**
+ * @class RSIActivityLog
+ * Keeps the seconds of activity and the break events on disk, one file per
+ * day, so they outlive rsibreak.
+ *
+ * A day file starts with a header and a bit per second of the day, about
+ * 11 KB, followed by the break events in the order they happened. Seconds
+ * are collected in memory and written at most every FLUSH_INTERVAL seconds,
+ * as the whole pages they are in, without syncing. Days are read back
+ * through memory maps.
+ */
+class RSIActivityLog
+{
+public:
+    /** A break event, as stored after the seconds of a day. */
+    struct Event {
+        qint64 time; // seconds since the epoch
+        qint32 stat; // the RSIStat which was increased
+        qint32 reserved;
+    };
+
+    /**
+     * A day file, memory mapped for reading. Call flush() first to see the
+     * latest seconds of the current day.
+     */
+    class Day
+    {
+    public:
+        Day(const RSIActivityLog &log, const QDate &date);
+
+        /** @returns false if there is no valid file for the day. */
+        bool isValid() const
+        {
+            return m_seconds != nullptr;
+        }
+
+        /** @returns the start of the day in seconds since the epoch. */
+        qint64 start() const
+        {
+            return m_start;
+        }
+
+        /** @returns the number of seconds of the day, usually 86400. */
+        int length() const
+        {
+            return m_length;
+        }
+
+        /** @returns a bit per second of the day, (length() + 7) / 8 bytes. */
+        const uchar *seconds() const
+        {
+            return m_seconds;
+        }
+
+        /** @returns whether second @p i of the day was active. */
+        bool isActive(int i) const
+        {
+            return m_seconds[i / 8] & (1 << (i % 8));
+        }
+
+        /** @returns the break events of the day, in the order they happened. */
+        QVector<Event> events() const;
+
+    private:
+        QFile m_file;
+        qint64 m_start;
+        int m_length;
+        const uchar *m_seconds = nullptr;
+    };
+
+    /** Seconds between writes of the collected seconds and events. */
+    static constexpr int FLUSH_INTERVAL = 5 * 60;
+
+    /**
+     * @param directory Where the day files are kept, created when the first
+     * one is written. A log which is only read never touches the disk.
+     */
+    explicit RSIActivityLog(const QString &directory);
+
+    /** Writes what was not written yet. */
+    ~RSIActivityLog();
+
+    /** @returns the directory the log of the user is kept in. */
+    static QString defaultDirectory();
+
+    /** @returns the path of the file of @p date. */
+    QString dayPath(const QDate &date) const;
+
+    /**
+     * Records the @p seconds seconds up to @p end as active or idle.
+     * @param end The second after the last one, since the epoch.
+     */
+    void record(bool active, qint64 seconds, qint64 end);
+
+    /** Records that @p stat was increased at @p time, in seconds since the epoch. */
+    void recordEvent(RSIStat stat, qint64 time);
+
+    /** Writes the collected seconds and events to the day file. */
+    void flush();
+
+    /**
+     * Also flush the log from the KCrash emergency save handler, so a crash
+     * loses nothing. Only one log can be flushed on crashes.
+     */
+    void flushOnCrash();
+
+    /**
+     * Also flush the log when the application quits, for when the owner of
+     * the log is not destroyed on the way out.
+     */
+    void flushOnQuit();
+
+    /**
+     * Resets @p history to the last week up to @p now, in seconds since the
+     * epoch. Seconds which are not in the log count as idle.
+     */
+    void replay(RSIActivityHistory &history, qint64 now);
+
+private:
+    static constexpr int HEADER_SIZE = 64;
+    // Long enough for the day the clocks go back.
+    static constexpr int DAY_SECONDS = 25 * 60 * 60;
+    static constexpr int EVENTS_OFFSET = HEADER_SIZE + DAY_SECONDS / 8;
+    static constexpr int PAGE_SIZE = 4096;
+
+    // Flushes the current day file and opens the one @p time is in.
+    void openDay(qint64 time);
+
+    // @returns true if @p data starts with a valid header.
+    static bool isValid(const char *data, qint64 size);
+
+    QString m_directory;
+    QFile m_file;
+
+    // The day of m_file, in seconds since the epoch.
+    qint64 m_dayStart = 0;
+    qint64 m_nextDayStart = 0;
+
+    // The header and seconds of the day, as in the file.
+    QByteArray m_image;
+    // The bytes of m_image which changed since the last flush.
+    int m_dirtyFrom = EVENTS_OFFSET;
+    int m_dirtyTo = 0;
+
+    QVector<Event> m_pendingEvents;
+    qint64 m_lastFlush = 0;
+
+    // To QCoreApplication::aboutToQuit(), see flushOnQuit().
+    QMetaObject::Connection m_quitConnection;
+};
+
+#endif // RSIBREAK_RSIACTIVITYLOG_H
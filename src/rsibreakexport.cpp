@@ -0,0 +1,85 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+#include "rsiactivitylog.h"
+#include "rsiexporter.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("rsibreak"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Exports the RSIBreak activity log, or the state of the running RSIBreak, as CSV or JSON lines. "
+                                                    "Days are read one at a time, so years of history take no more memory than a day."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("what"),
+                                 QStringLiteral("days: totals per day, events: break events, activity: runs of active seconds, "
+                                                "session: the statistics and timers of the running RSIBreak."));
+    parser.addOption(QCommandLineOption(QStringLiteral("format"), QStringLiteral("csv or jsonl, csv by default."), QStringLiteral("format"), QStringLiteral("csv")));
+    parser.addOption(QCommandLineOption(QStringLiteral("from"), QStringLiteral("First day to export, by default the first logged one."), QStringLiteral("yyyy-mm-dd")));
+    parser.addOption(QCommandLineOption(QStringLiteral("to"), QStringLiteral("Last day to export, by default today."), QStringLiteral("yyyy-mm-dd")));
+    parser.addOption(QCommandLineOption(QStringLiteral("log"), QStringLiteral("Directory of the activity log."), QStringLiteral("directory"), RSIActivityLog::defaultDirectory()));
+    parser.addOption(QCommandLineOption(QStringLiteral("output"), QStringLiteral("Write to <file> instead of stdout."), QStringLiteral("file")));
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QString what = parser.positionalArguments().value(0);
+    const QString format = parser.value(QStringLiteral("format"));
+    const QStringList whats = {QStringLiteral("days"), QStringLiteral("events"), QStringLiteral("activity"), QStringLiteral("session")};
+    if (parser.positionalArguments().size() != 1 || !whats.contains(what) || (format != QLatin1String("csv") && format != QLatin1String("jsonl"))) {
+        parser.showHelp(1);
+    }
+
+    for (const QString &option : {QStringLiteral("from"), QStringLiteral("to")}) {
+        if (parser.isSet(option) && !QDate::fromString(parser.value(option), Qt::ISODate).isValid()) {
+            err << "Invalid date for --" << option << ", expected yyyy-mm-dd: " << parser.value(option) << Qt::endl;
+            return 1;
+        }
+    }
+
+    const QString directory = parser.value(QStringLiteral("log"));
+    QDate from = QDate::fromString(parser.value(QStringLiteral("from")), Qt::ISODate);
+    QDate to = parser.isSet(QStringLiteral("to")) ? QDate::fromString(parser.value(QStringLiteral("to")), Qt::ISODate) : QDate::currentDate();
+    if (!from.isValid()) {
+        from = RSIExporter::firstLoggedDay(directory);
+        // Nothing logged, nothing to export.
+        if (!from.isValid()) {
+            from = to.addDays(1);
+        }
+    }
+
+    QFile outFile;
+    if (parser.isSet(QStringLiteral("output"))) {
+        outFile.setFileName(parser.value(QStringLiteral("output")));
+        if (!outFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            err << outFile.fileName() << ": " << outFile.errorString() << Qt::endl;
+            return 1;
+        }
+    } else {
+        outFile.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+    QTextStream out(&outFile);
+
+    // Nothing is written to the log, the running rsibreak owns it, and
+    // reading it does not create the directory.
+    const RSIActivityLog log(directory);
+    RSIExporter exporter(log, out, format == QLatin1String("jsonl") ? RSIExporter::Format::JsonLines : RSIExporter::Format::Csv);
+    if (what == QLatin1String("days")) {
+        exporter.exportDays(from, to);
+    } else if (what == QLatin1String("events")) {
+        exporter.exportEvents(from, to);
+    } else if (what == QLatin1String("activity")) {
+        exporter.exportActivity(from, to);
+    } else if (!exporter.exportSession()) {
+        err << "RSIBreak is not running" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include "rsiglobals.h"
+#include "rsiidletrace.h"
+#include "rsisimulator.h"
+
+// Command line options overriding the configured intervals, in seconds.
+static const struct {
+    const char *name;
+    RSIInterval interval;
+    const char *description;
+} intervalOptions[] = {
+    {"tiny-interval", TINY_BREAK_INTERVAL, "Seconds of activity before a tiny break, 0 disables them."},
+    {"tiny-duration", TINY_BREAK_DURATION, "Seconds a tiny break lasts."},
+    {"tiny-threshold", TINY_BREAK_THRESHOLD, "Seconds of idling which count as a tiny break."},
+    {"big-interval", BIG_BREAK_INTERVAL, "Seconds of activity before a big break."},
+    {"big-duration", BIG_BREAK_DURATION, "Seconds a big break lasts."},
+    {"big-threshold", BIG_BREAK_THRESHOLD, "Seconds of idling which count as a big break."},
+    {"postpone", POSTPONE_BREAK_INTERVAL, "Seconds a break is postponed by."},
+    {"patience", PATIENCE_INTERVAL, "Seconds a suggested break waits before it is enforced."},
+    {"short-input", SHORT_INPUT_INTERVAL, "Seconds of input which interrupt a suggested break."},
+};
+
+int main(int argc, char *argv[])
+{
+    // The statistics are kept in widgets, but nothing is ever shown.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("rsibreak"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Simulates the RSIBreak timer on a trace of idle notifications and prints a timeline "
+                                                    "of break suggestions, rests, skips and idle resets. The intervals default to the "
+                                                    "configured ones."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("trace"),
+                                 QStringLiteral("Trace with one \"<second> <idle|active|skip|postpone|lock>\" line per event, or idle notifications "
+                                                "captured with the IdleCaptureFile setting."));
+    parser.addOption(QCommandLineOption(QStringLiteral("office"), QStringLiteral("Simulate <days> days of generated office hours instead of a trace."), QStringLiteral("days")));
+    parser.addOption(QCommandLineOption(QStringLiteral("seed"), QStringLiteral("Seed for the generated office hours."), QStringLiteral("seed"), QStringLiteral("1")));
+    parser.addOption(QCommandLineOption(QStringLiteral("duration"), QStringLiteral("Seconds to simulate, by default up to the last event."), QStringLiteral("seconds")));
+    parser.addOption(QCommandLineOption(QStringLiteral("output"), QStringLiteral("Write the timeline to <file> instead of stdout."), QStringLiteral("file")));
+    parser.addOption(QCommandLineOption(QStringLiteral("no-popup"), QStringLiteral("Start breaks right away instead of suggesting them.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("no-idle-timers"), QStringLiteral("Do not count idling as a break.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("tier"),
+                                        QStringLiteral("Add a break tier, instead of the configured extra ones. Can be given more than once."),
+                                        QStringLiteral("interval,duration,threshold")));
+    for (const auto &option : intervalOptions) {
+        parser.addOption(QCommandLineOption(QString::fromLatin1(option.name), QString::fromLatin1(option.description), QStringLiteral("seconds")));
+    }
+    parser.process(app);
+
+    QTextStream err(stderr);
+    QVector<int> intervals = RSIGlobals::instance()->intervals();
+    for (const auto &option : intervalOptions) {
+        const QString name = QString::fromLatin1(option.name);
+        if (parser.isSet(name)) {
+            intervals[option.interval] = parser.value(name).toInt();
+        }
+    }
+    if (parser.isSet(QStringLiteral("tier"))) {
+        intervals.resize(INTERVAL_COUNT);
+        for (const QString &tier : parser.values(QStringLiteral("tier"))) {
+            const QStringList fields = tier.split(QLatin1Char(','));
+            if (fields.size() != TIER_FIELD_COUNT) {
+                err << "Invalid tier: " << tier << Qt::endl;
+                return 1;
+            }
+            for (const QString &field : fields) {
+                intervals << field.toInt();
+            }
+        }
+    }
+
+    QVector<RSISimulator::TraceEvent> trace;
+    qint64 duration = 0;
+    if (parser.isSet(QStringLiteral("office"))) {
+        const int days = parser.value(QStringLiteral("office")).toInt();
+        trace = RSISimulator::officeTrace(days, parser.value(QStringLiteral("seed")).toUInt());
+        duration = days * 24 * 60 * 60LL;
+    } else if (parser.positionalArguments().size() == 1) {
+        QFile file(parser.positionalArguments().constFirst());
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << file.fileName() << ": " << file.errorString() << Qt::endl;
+            return 1;
+        }
+        QString error;
+        const bool read = RSIIdleTrace::isTrace(&file) ? RSISimulator::readIdleTrace(&file, trace, &error) : RSISimulator::readTrace(&file, trace, &error);
+        if (!read) {
+            err << file.fileName() << ": " << error << Qt::endl;
+            return 1;
+        }
+        duration = trace.isEmpty() ? 0 : trace.constLast().second;
+    } else {
+        parser.showHelp(1);
+    }
+    if (parser.isSet(QStringLiteral("duration"))) {
+        duration = parser.value(QStringLiteral("duration")).toLongLong();
+    }
+
+    QFile outFile;
+    if (parser.isSet(QStringLiteral("output"))) {
+        outFile.setFileName(parser.value(QStringLiteral("output")));
+        if (!outFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            err << outFile.fileName() << ": " << outFile.errorString() << Qt::endl;
+            return 1;
+        }
+    } else {
+        outFile.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+    QTextStream out(&outFile);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    RSISimulator simulator(intervals, !parser.isSet(QStringLiteral("no-popup")), !parser.isSet(QStringLiteral("no-idle-timers")), out);
+    simulator.run(trace, duration);
+
+    err << "Simulated " << duration << " seconds in " << elapsed.elapsed() << " ms" << Qt::endl;
+    const QMap<QString, int> &counts = simulator.counts();
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        err << it.key() << ": " << it.value() << Qt::endl;
+    }
+    return 0;
+}
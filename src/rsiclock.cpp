@@ -0,0 +1,39 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiclock.h"
+
+#include <QElapsedTimer>
+
+#ifdef Q_OS_LINUX
+#include <time.h>
+
+static qint64 clockMSecs(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+#endif
+
+qint64 RSIClockImpl::monotonicMSecs() const
+{
+#ifdef Q_OS_LINUX
+    return clockMSecs(CLOCK_MONOTONIC);
+#else
+    QElapsedTimer timer;
+    timer.start();
+    return timer.msecsSinceReference();
+#endif
+}
+
+qint64 RSIClockImpl::boottimeMSecs() const
+{
+#ifdef Q_OS_LINUX
+    return clockMSecs(CLOCK_BOOTTIME);
+#else
+    // No way to tell a suspend apart here, so never report one.
+    return monotonicMSecs();
+#endif
+}
@@ -0,0 +1,73 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSICLOCK_H
+#define RSIBREAK_RSICLOCK_H
+
+#include <QtGlobal>
+
+/**
+ * Abstract interface for the clocks RSITimer measures elapsed time with.
+ * Both clocks only ever move forward, so NTP or DST changes do not matter.
+ */
+class RSIClock
+{
+public:
+    RSIClock() = default;
+    virtual ~RSIClock() = default;
+
+    /**
+     * Milliseconds on a clock which stands still during suspend-to-RAM.
+     */
+    virtual qint64 monotonicMSecs() const = 0;
+
+    /**
+     * Milliseconds on a clock which keeps counting during suspend-to-RAM.
+     * Comparing it with monotonicMSecs() tells a suspend from a stall.
+     */
+    virtual qint64 boottimeMSecs() const = 0;
+};
+
+/**
+ * Real implementation using CLOCK_MONOTONIC and CLOCK_BOOTTIME.
+ */
+class RSIClockImpl : public RSIClock
+{
+public:
+    qint64 monotonicMSecs() const override;
+    qint64 boottimeMSecs() const override;
+};
+
+/**
+ * Fake implementation for testing.
+ */
+class RSIClockFake : public RSIClock
+{
+public:
+    qint64 monotonicMSecs() const override
+    {
+        return m_monotonic;
+    }
+    qint64 boottimeMSecs() const override
+    {
+        return m_boottime;
+    }
+
+    // Test helper methods
+    void advance(qint64 msec)
+    {
+        m_monotonic += msec;
+        m_boottime += msec;
+    }
+    void suspend(qint64 msec)
+    {
+        m_boottime += msec;
+    }
+
+private:
+    qint64 m_monotonic = 0;
+    qint64 m_boottime = 0;
+};
+
+#endif // RSIBREAK_RSICLOCK_H
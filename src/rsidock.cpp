@@ -175,6 +175,7 @@ void RSIDock::slotShowStatistics()
         m_statsDialog->hide();
     } else {
         PlatformHelper::activateWindow(m_statsDialog);
+        emit statisticsShown();
     }
 }
 
@@ -197,6 +198,14 @@ static QString colorizedText(const QString &text, const QColor &color)
     return QString("<font color='%1'>&#9679;</font> %2").arg(color.name(), text.toHtmlEscaped());
 }
 
+void RSIDock::setSnapshot(const RSITimerSnapshot &snapshot)
+{
+    if (snapshot.tinyLeft != m_snapshot.tinyLeft || snapshot.bigLeft != m_snapshot.bigLeft) {
+        setCounters(snapshot.tinyLeft, snapshot.bigLeft);
+    }
+    m_snapshot = snapshot;
+}
+
 void RSIDock::setCounters(int tiny_left, int big_left)
 {
     if (m_suspended)
@@ -207,11 +216,13 @@ void RSIDock::setCounters(int tiny_left, int big_left)
         QColor tinyColor;
         if (tinyBreaks) {
             tinyColor = RSIGlobals::instance()->getTinyBreakColor(tiny_left);
-            RSIGlobals::instance()->stats()->setColor(LAST_TINY_BREAK, tinyColor);
+            if (m_statsWidget)
+                m_statsWidget->setBreakColor(LAST_TINY_BREAK, tinyColor);
         }
 
         QColor bigColor = RSIGlobals::instance()->getBigBreakColor(big_left);
-        RSIGlobals::instance()->stats()->setColor(LAST_BIG_BREAK, bigColor);
+        if (m_statsWidget)
+            m_statsWidget->setBreakColor(LAST_BIG_BREAK, bigColor);
 
         // Only add the line for the tiny break when there is not
         // a big break planned at the same time.
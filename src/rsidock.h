@@ -26,6 +26,8 @@
 
 #include <kstatusnotifieritem.h>
 
+#include "rsitimersnapshot.h"
+
 class QDialog;
 class KHelpMenu;
 
@@ -59,6 +61,12 @@ public:
 public slots:
     void setCounters(int tiny_left, int big_left);
 
+    /**
+     * Updates the tooltip if the counters in @p snapshot differ from
+     * the ones of the last snapshot.
+     */
+    void setSnapshot(const RSITimerSnapshot &snapshot);
+
 signals:
     /**
      * This signal is emitted when the user has left
@@ -90,6 +98,12 @@ signals:
      */
     void suspend(bool);
 
+    /**
+     * This signal is emitted when the statistics dialog is shown,
+     * its values need updating every second from then on.
+     */
+    void statisticsShown();
+
 private slots:
     void slotConfigure();
     void slotConfigureNotifications();
@@ -105,6 +119,8 @@ private:
 
     QDialog *m_statsDialog;
     RSIStatWidget *m_statsWidget;
+
+    RSITimerSnapshot m_snapshot;
 };
 
 #endif // RSIDOCK_H
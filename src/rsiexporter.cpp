@@ -0,0 +1,217 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiexporter.h"
+
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include "rsiactivitylog.h"
+#include "rsihistory.h"
+
+static QString isoTime(const qint64 time)
+{
+    return QDateTime::fromSecsSinceEpoch(time).toString(Qt::ISODate);
+}
+
+// @returns "tinyLeft" as "tiny_left", for the column names.
+static QString snakeCase(const QString &key)
+{
+    QString name;
+    for (const QChar c : key) {
+        if (c.isUpper()) {
+            name += QLatin1Char('_');
+        }
+        name += c.toLower();
+    }
+    return name;
+}
+
+/**
+ * Writes rows of named values, as CSV with a header line or as one JSON
+ * object per line. Every row is written out right away.
+ */
+class RowWriter
+{
+public:
+    RowWriter(QTextStream &out, const bool json, const QStringList &columns)
+        : m_out(out)
+        , m_json(json)
+        , m_columns(columns)
+    {
+        if (!m_json) {
+            m_out << m_columns.join(QLatin1Char(',')) << '\n';
+        }
+    }
+
+    void write(const QVariantList &values)
+    {
+        if (m_json) {
+            QJsonObject object;
+            for (int i = 0; i < m_columns.size(); ++i) {
+                object.insert(m_columns[i], QJsonValue::fromVariant(values[i]));
+            }
+            m_out << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+        } else {
+            QStringList fields;
+            for (const QVariant &value : values) {
+                fields << value.toString();
+            }
+            m_out << fields.join(QLatin1Char(',')) << '\n';
+        }
+    }
+
+private:
+    QTextStream &m_out;
+    const bool m_json;
+    const QStringList m_columns;
+};
+
+RSIExporter::RSIExporter(const RSIActivityLog &log, QTextStream &out, Format format)
+    : m_log(log)
+    , m_out(out)
+    , m_json(format == Format::JsonLines)
+{
+}
+
+void RSIExporter::exportDays(const QDate &from, const QDate &to)
+{
+    RowWriter writer(m_out, m_json, {QStringLiteral("date"),
+                                     QStringLiteral("active_seconds"),
+                                     QStringLiteral("breaks_taken"),
+                                     QStringLiteral("breaks_skipped"),
+                                     QStringLiteral("breaks_postponed"),
+                                     QStringLiteral("longest_stretch")});
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        const RSIActivityLog::Day day(m_log, date);
+        if (!day.isValid()) {
+            continue;
+        }
+        const RSIHistory::DayRollup rollup = RSIHistory::rollUp(day);
+        writer.write({date.toString(Qt::ISODate),
+                      rollup.total.activeSeconds,
+                      rollup.total.breaksTaken,
+                      rollup.total.breaksSkipped,
+                      rollup.total.breaksPostponed,
+                      rollup.longestStretch});
+    }
+}
+
+void RSIExporter::exportEvents(const QDate &from, const QDate &to)
+{
+    RowWriter writer(m_out, m_json, {QStringLiteral("time"), QStringLiteral("event")});
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        const RSIActivityLog::Day day(m_log, date);
+        const QVector<RSIActivityLog::Event> events = day.events();
+        for (const RSIActivityLog::Event &event : events) {
+            writer.write({isoTime(event.time), eventName(event.stat)});
+        }
+    }
+}
+
+void RSIExporter::exportActivity(const QDate &from, const QDate &to)
+{
+    RowWriter writer(m_out, m_json, {QStringLiteral("start"), QStringLiteral("end"), QStringLiteral("seconds")});
+    qint64 runStart = -1;
+    qint64 runEnd = -1;
+    auto flushRun = [&]() {
+        if (runStart >= 0) {
+            writer.write({isoTime(runStart), isoTime(runEnd), runEnd - runStart});
+        }
+        runStart = -1;
+    };
+
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        const RSIActivityLog::Day day(m_log, date);
+        if (!day.isValid()) {
+            flushRun();
+            continue;
+        }
+
+        const uchar *bits = day.seconds();
+        for (int i = 0; i < day.length();) {
+            // Whole idle bytes are skipped at once.
+            if (i % 8 == 0 && bits[i / 8] == 0) {
+                flushRun();
+                i += 8;
+                continue;
+            }
+            if (day.isActive(i)) {
+                if (runStart < 0) {
+                    runStart = day.start() + i;
+                }
+                runEnd = day.start() + i + 1;
+            } else {
+                flushRun();
+            }
+            ++i;
+        }
+    }
+    flushRun();
+}
+
+bool RSIExporter::exportSession()
+{
+    QDBusInterface rsibreak(QStringLiteral("org.kde.rsibreak"), QStringLiteral("/rsibreak"), QStringLiteral("org.rsibreak.rsiwidget"));
+    const QDBusReply<QVariantMap> stats = rsibreak.call(QStringLiteral("stats"));
+    if (!stats.isValid()) {
+        return false;
+    }
+
+    // The columns are whatever the running version has, in key order.
+    QStringList columns = {QStringLiteral("time")};
+    QVariantList values = {isoTime(QDateTime::currentSecsSinceEpoch())};
+    const QVariantMap map = stats.value();
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        columns << snakeCase(it.key());
+        values << it.value();
+    }
+    RowWriter writer(m_out, m_json, columns);
+    writer.write(values);
+    return true;
+}
+
+QDate RSIExporter::firstLoggedDay(const QString &directory)
+{
+    // Without keeping the list of files.
+    QDate first;
+    QDirIterator files(directory, {QStringLiteral("*.log")}, QDir::Files);
+    while (files.hasNext()) {
+        files.next();
+        const QDate date = QDate::fromString(files.fileInfo().completeBaseName(), Qt::ISODate);
+        if (date.isValid() && (!first.isValid() || date < first)) {
+            first = date;
+        }
+    }
+    return first;
+}
+
+QString RSIExporter::eventName(const int stat)
+{
+    switch (stat) {
+    case TINY_BREAKS:
+        return QStringLiteral("tiny_break");
+    case TINY_BREAKS_SKIPPED:
+        return QStringLiteral("tiny_break_skipped");
+    case TINY_BREAKS_POSTPONED:
+        return QStringLiteral("tiny_break_postponed");
+    case IDLENESS_CAUSED_SKIP_TINY:
+        return QStringLiteral("tiny_break_idle");
+    case BIG_BREAKS:
+        return QStringLiteral("big_break");
+    case BIG_BREAKS_SKIPPED:
+        return QStringLiteral("big_break_skipped");
+    case BIG_BREAKS_POSTPONED:
+        return QStringLiteral("big_break_postponed");
+    case IDLENESS_CAUSED_SKIP_BIG:
+        return QStringLiteral("big_break_idle");
+    default:
+        return QStringLiteral("stat%1").arg(stat);
+    }
+}
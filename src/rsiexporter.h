@@ -0,0 +1,62 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIEXPORTER_H
+#define RSIBREAK_RSIEXPORTER_H
+
+#include <QDate>
+#include <QString>
+
+class QTextStream;
+class RSIActivityLog;
+
+/**
+ * @class RSIExporter
+ * Writes the activity log, or the statistics of the running rsibreak, as
+ * CSV with a header line or as one JSON object per line. Days are read one
+ * at a time and every row is written out right away, so years of history
+ * take no more memory than a day.
+ */
+class RSIExporter
+{
+public:
+    enum class Format {
+        Csv,
+        JsonLines
+    };
+
+    RSIExporter(const RSIActivityLog &log, QTextStream &out, Format format);
+
+    /** One row of totals per logged day from @p from to @p to, both included. */
+    void exportDays(const QDate &from, const QDate &to);
+
+    /** One row per break event from @p from to @p to, both included. */
+    void exportEvents(const QDate &from, const QDate &to);
+
+    /**
+     * One row per run of active seconds from @p from to @p to, both
+     * included. Runs go on across midnight.
+     */
+    void exportActivity(const QDate &from, const QDate &to);
+
+    /**
+     * One row with everything the stats() D-Bus call of the running rsibreak
+     * returns, with the keys in snake_case.
+     * @returns false if rsibreak is not running.
+     */
+    bool exportSession();
+
+    /** @returns the first day logged in @p directory, invalid if there is none. */
+    static QDate firstLoggedDay(const QString &directory);
+
+    /** @returns the exported name of the logged break event @p stat. */
+    static QString eventName(int stat);
+
+private:
+    const RSIActivityLog &m_log;
+    QTextStream &m_out;
+    const bool m_json;
+};
+
+#endif // RSIBREAK_RSIEXPORTER_H
@@ -7,6 +7,9 @@
 
 #include "rsiglobals.h"
 
+#include <QCoreApplication>
+#include <QEvent>
+
 #include <kconfig.h>
 #include <kconfiggroup.h>
 #include <klocalizedstring.h>
@@ -21,11 +24,19 @@
 RSIGlobals *RSIGlobals::m_instance = nullptr;
 RSIStats *RSIGlobals::m_stats = nullptr;
 
+// Enough for every second below an hour, which the tooltip counts down in.
+static constexpr int FORMAT_CACHE_SIZE = 4096;
+
 RSIGlobals::RSIGlobals(QObject *parent)
     : QObject(parent)
+    , m_formatCache(FORMAT_CACHE_SIZE)
 {
-    resetUsage();
     slotReadConfig();
+
+    // Language changes are sent to the application object.
+    if (QCoreApplication::instance()) {
+        QCoreApplication::instance()->installEventFilter(this);
+    }
 }
 
 RSIGlobals::~RSIGlobals()
@@ -46,7 +57,21 @@ RSIGlobals *RSIGlobals::instance()
 
 QString RSIGlobals::formatSeconds(const int seconds)
 {
-    return m_format.formatSpelloutDuration(seconds * 1000);
+    if (const QString *cached = m_formatCache.object(seconds)) {
+        return *cached;
+    }
+    const QString text = m_format.formatSpelloutDuration(seconds * 1000LL);
+    m_formatCache.insert(seconds, new QString(text));
+    return text;
+}
+
+bool RSIGlobals::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == QCoreApplication::instance() && (event->type() == QEvent::LanguageChange || event->type() == QEvent::LocaleChange)) {
+        m_format = KFormat();
+        m_formatCache.clear();
+    }
+    return QObject::eventFilter(watched, event);
 }
 
 void RSIGlobals::slotReadConfig()
@@ -69,6 +94,34 @@ void RSIGlobals::slotReadConfig()
     m_intervals[POSTPONE_BREAK_INTERVAL] = config.readEntry("PostponeBreakDuration", 5) * mult;
     m_intervals[PATIENCE_INTERVAL] = config.readEntry("Patience", 30);
     m_intervals[SHORT_INPUT_INTERVAL] = config.readEntry("ShortInputInterval", 2);
+
+    // Extra break tiers, from "Break Tier 1" on, in TIER_FIELD order.
+    for (int tier = 1;; ++tier) {
+        const KConfigGroup tierConfig = KSharedConfig::openConfig()->group(QStringLiteral("Break Tier %1").arg(tier));
+        if (!tierConfig.exists()) {
+            break;
+        }
+        m_intervals << tierConfig.readEntry("Interval", 0) * mult;
+        m_intervals << tierConfig.readEntry("Duration", 0);
+        m_intervals << tierConfig.readEntry("Threshold", 0);
+    }
+}
+
+int RSIGlobals::tierCount(const QVector<int> &intervals)
+{
+    return 2 + (intervals.size() - INTERVAL_COUNT) / TIER_FIELD_COUNT;
+}
+
+int RSIGlobals::tierSlot(const int tier, const RSITierField field)
+{
+    switch (tier) {
+    case 0:
+        return TINY_BREAK_INTERVAL + field;
+    case 1:
+        return BIG_BREAK_INTERVAL + field;
+    default:
+        return INTERVAL_COUNT + (tier - 2) * TIER_FIELD_COUNT + field;
+    }
 }
 
 QColor RSIGlobals::getTinyBreakColor(int secsToBreak) const
@@ -93,7 +146,17 @@ QColor RSIGlobals::getBigBreakColor(int secsToBreak) const
     return QColor((int)(255 - 2.55 * v), (int)(1.60 * v), 0);
 }
 
-void RSIGlobals::resetUsage()
+int RSIGlobals::iconLevel(double idleAvg)
 {
-    m_usageArray.fill(false, 60 * 60 * 24);
+    if (idleAvg == 0.0)
+        return 0;
+    else if (idleAvg > 0 && idleAvg < 30)
+        return 1;
+    else if (idleAvg >= 30 && idleAvg < 60)
+        return 2;
+    else if (idleAvg >= 60 && idleAvg < 90)
+        return 3;
+    else
+        return 4;
 }
+
@@ -7,7 +7,7 @@
 #ifndef RSIGLOBALS_H
 #define RSIGLOBALS_H
 
-#include <QBitArray>
+#include <QCache>
 #include <QObject>
 #include <QStringList>
 #include <qmap.h>
@@ -54,6 +54,19 @@ enum RSIInterval {
     INTERVAL_COUNT
 };
 
+/**
+ * The settings of a break tier. The tiny and big breaks are tiers 0 and 1,
+ * with their settings at TINY_BREAK_INTERVAL and BIG_BREAK_INTERVAL. Any
+ * further tiers, e.g. micro pauses or a lunch reminder, follow INTERVAL_COUNT
+ * in the intervals, TIER_FIELD_COUNT entries each.
+ */
+enum RSITierField {
+    TIER_INTERVAL = 0,
+    TIER_DURATION,
+    TIER_THRESHOLD,
+    TIER_FIELD_COUNT
+};
+
 /**
  * @class RSIGlobals
  * This class consists of a few commonly used routines and values.
@@ -87,7 +100,9 @@ public:
     }
 
     /**
-     * Converts @p seconds to a reasonable string.
+     * Converts @p seconds to a reasonable string. The strings are cached,
+     * as the same ones are asked for every second, until the language or
+     * locale changes.
      * @param seconds the amount of seconds
      * @returns a formatted string.
      */
@@ -103,6 +118,17 @@ public:
         return m_intervals;
     }
 
+    /**
+     * Returns the number of break tiers in @p intervals, at least the tiny
+     * and big breaks.
+     */
+    static int tierCount(const QVector<int> &intervals);
+
+    /**
+     * Returns the index of @p field of break tier @p tier in the intervals.
+     */
+    static int tierSlot(const int tier, const RSITierField field);
+
     /**
      * Returns true if tiny breaks are to be made at all.
      */
@@ -124,22 +150,10 @@ public:
     QColor getBigBreakColor(int secsToBreak) const;
 
     /**
-     * Returns the array which keeps track per second for 24 hours when the
-     * user was active or idle. Activity = 1, idle = 0.
-     * The RSIStatBitArrayItem can read and write a certain interval of this
-     * array, for example to measure the activity in 60 seconds or 1 hour.
-     *
-     * @see RSIStatBitArrayItem
+     * Maps how close the next break is, from 0 to 100, to one of the
+     * rsibreak0 to rsibreak4 tray icons.
      */
-    QBitArray *usageArray()
-    {
-        return &m_usageArray;
-    }
-
-    /**
-     * Resets the usage array, with all values to 0.
-     */
-    void resetUsage();
+    static int iconLevel(double idleAvg);
 
     /**
      *
@@ -156,12 +170,17 @@ public slots:
      */
     void slotReadConfig();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
     static RSIGlobals *m_instance;
     static RSIStats *m_stats;
     QVector<int> m_intervals;
-    QBitArray m_usageArray;
     KFormat m_format;
+
+    // Strings of formatSeconds() by seconds, at most FORMAT_CACHE_SIZE of them.
+    QCache<int, QString> m_formatCache;
 };
 
 #endif // RSIGLOBALS_H
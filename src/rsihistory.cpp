@@ -0,0 +1,201 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsihistory.h"
+
+#include <QDateTime>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cstring>
+
+// @returns the number of bits set in the @p count bytes at @p bytes.
+static qint64 countBits(const uchar *bytes, int count)
+{
+    qint64 bits = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        quint64 word;
+        memcpy(&word, bytes + i, sizeof(word));
+        bits += qPopulationCount(word);
+    }
+    for (; i < count; ++i) {
+        bits += qPopulationCount(bytes[i]);
+    }
+    return bits;
+}
+
+// @returns the longest run of active seconds in @p day, bridging idle gaps
+// shorter than RSIHistory::STRETCH_GAP.
+static int longestStretch(const RSIActivityLog::Day &day)
+{
+    const int bytes = (day.length() + 7) / 8;
+    int longest = 0;
+    int stretchStart = 0;
+    int lastActive = -RSIHistory::STRETCH_GAP; // the end of the last run
+
+    for (int offset = 0; offset < bytes; offset += 8) {
+        quint64 word = 0;
+        memcpy(&word, day.seconds() + offset, std::min(8, bytes - offset));
+
+        // Takes the runs of set bits off the word, lowest first.
+        while (word) {
+            const int bit = qCountTrailingZeroBits(word);
+            const quint64 rest = ~(word >> bit);
+            const int length = rest ? qCountTrailingZeroBits(rest) : 64 - bit;
+            const int runStart = offset * 8 + bit;
+
+            if (runStart - lastActive >= RSIHistory::STRETCH_GAP) {
+                stretchStart = runStart;
+            }
+            lastActive = runStart + length;
+            longest = std::max(longest, lastActive - stretchStart);
+
+            word = bit + length == 64 ? 0 : word & ~(((quint64(1) << length) - 1) << bit);
+        }
+    }
+    return longest;
+}
+
+RSIHistory::Counts &RSIHistory::Counts::operator+=(const Counts &other)
+{
+    activeSeconds += other.activeSeconds;
+    breaksTaken += other.breaksTaken;
+    breaksSkipped += other.breaksSkipped;
+    breaksPostponed += other.breaksPostponed;
+    return *this;
+}
+
+RSIHistory::RSIHistory(RSIActivityLog *log)
+    : m_log(log)
+{
+}
+
+RSIHistory::DayRollup RSIHistory::rollUp(const RSIActivityLog::Day &day)
+{
+    DayRollup rollup;
+    if (!day.isValid()) {
+        return rollup;
+    }
+
+    // Hours are whole bytes, and the clocks only change on the hour.
+    static constexpr int HOUR = 60 * 60;
+    for (int start = 0; start < day.length(); start += HOUR) {
+        const int hour = QDateTime::fromSecsSinceEpoch(day.start() + start).time().hour();
+        const qint64 active = countBits(day.seconds() + start / 8, std::min(HOUR, day.length() - start) / 8);
+        rollup.hours[hour].activeSeconds += active;
+        rollup.total.activeSeconds += active;
+    }
+
+    // Break events are logged when a break is suggested, and once more when
+    // it is skipped or postponed. A suggestion is taken unless one of those
+    // follows before the next suggestion of the same kind; it is counted in
+    // the hour it was suggested in.
+    int pendingHour[2] = {-1, -1}; // tiny, big
+    auto settle = [&rollup](int &pending, bool taken) {
+        if (pending >= 0 && taken) {
+            ++rollup.hours[pending].breaksTaken;
+            ++rollup.total.breaksTaken;
+        }
+        pending = -1;
+    };
+
+    const QVector<RSIActivityLog::Event> events = day.events();
+    for (const RSIActivityLog::Event &event : events) {
+        const int hourOfDay = QDateTime::fromSecsSinceEpoch(event.time).time().hour();
+        Counts &hour = rollup.hours[hourOfDay];
+        switch (event.stat) {
+        case TINY_BREAKS:
+        case BIG_BREAKS: {
+            int &pending = pendingHour[event.stat == BIG_BREAKS];
+            settle(pending, true);
+            pending = hourOfDay;
+            break;
+        }
+        case TINY_BREAKS_SKIPPED:
+        case BIG_BREAKS_SKIPPED:
+            settle(pendingHour[event.stat == BIG_BREAKS_SKIPPED], false);
+            ++hour.breaksSkipped;
+            ++rollup.total.breaksSkipped;
+            break;
+        case TINY_BREAKS_POSTPONED:
+        case BIG_BREAKS_POSTPONED:
+            settle(pendingHour[event.stat == BIG_BREAKS_POSTPONED], false);
+            ++hour.breaksPostponed;
+            ++rollup.total.breaksPostponed;
+            break;
+        default:
+            break;
+        }
+    }
+    settle(pendingHour[0], true);
+    settle(pendingHour[1], true);
+
+    rollup.longestStretch = longestStretch(day);
+    return rollup;
+}
+
+const RSIHistory::DayRollup &RSIHistory::day(const QDate &date)
+{
+    static const DayRollup empty;
+
+    const QDate today = QDate::currentDate();
+    if (date > today) {
+        return empty;
+    }
+    if (date == today) {
+        m_log->flush();
+        m_today = rollUp(RSIActivityLog::Day(*m_log, date));
+        return m_today;
+    }
+
+    auto it = m_rollups.constFind(date);
+    if (it == m_rollups.constEnd()) {
+        it = m_rollups.insert(date, rollUp(RSIActivityLog::Day(*m_log, date)));
+    }
+    return *it;
+}
+
+QVector<RSIHistory::Aggregate> RSIHistory::query(const QDate &from, const QDate &to, Grouping grouping)
+{
+    QVector<Aggregate> result;
+    if (grouping == Grouping::HourOfDay) {
+        result.resize(24);
+        for (int hour = 0; hour < 24; ++hour) {
+            result[hour].start = from;
+            result[hour].hour = hour;
+        }
+    }
+
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        const DayRollup &rollup = day(date);
+        const Counts &total = rollup.total;
+        if (grouping != Grouping::HourOfDay && total.activeSeconds == 0 && total.breaksTaken == 0 && total.breaksSkipped == 0
+            && total.breaksPostponed == 0) {
+            continue;
+        }
+
+        switch (grouping) {
+        case Grouping::Day:
+            result.append({date, -1, total, rollup.longestStretch});
+            break;
+        case Grouping::Week: {
+            const QDate monday = date.addDays(1 - date.dayOfWeek());
+            if (result.isEmpty() || result.constLast().start != monday) {
+                result.append({monday, -1, Counts(), 0});
+            }
+            Aggregate &week = result.last();
+            week.counts += total;
+            week.longestStretch = std::max(week.longestStretch, rollup.longestStretch);
+            break;
+        }
+        case Grouping::HourOfDay:
+            for (int hour = 0; hour < 24; ++hour) {
+                result[hour].counts += rollup.hours[hour];
+            }
+            break;
+        }
+    }
+    return result;
+}
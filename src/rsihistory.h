@@ -0,0 +1,79 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIHISTORY_H
+#define RSIBREAK_RSIHISTORY_H
+
+#include <QDate>
+#include <QHash>
+#include <QVector>
+#include <array>
+
+#include "rsiactivitylog.h"
+
+/**
+ * @class RSIHistory
+ * Answers questions about past days from the activity log: active time,
+ * breaks taken and skipped, and the longest stretch of work, per day, per
+ * week or per hour of the day.
+ *
+ * Every day is rolled up once, counting the seconds a 64 bit word at a
+ * time, and kept. Only today is rolled up again, as it is still written.
+ */
+class RSIHistory
+{
+public:
+    /** Idle gaps shorter than this do not end a stretch of work, in seconds. */
+    static constexpr int STRETCH_GAP = 60;
+
+    enum class Grouping {
+        Day,
+        Week, // starting on Monday
+        HourOfDay
+    };
+
+    struct Counts {
+        qint64 activeSeconds = 0;
+        int breaksTaken = 0; // suggested and neither skipped nor postponed, or taken care of by idleness
+        int breaksSkipped = 0;
+        int breaksPostponed = 0;
+
+        Counts &operator+=(const Counts &other);
+    };
+
+    struct DayRollup {
+        Counts total;
+        std::array<Counts, 24> hours; // by hour of the local time
+        int longestStretch = 0; // seconds
+    };
+
+    struct Aggregate {
+        QDate start; // the day, or the first day of the week or the query
+        int hour = -1; // for Grouping::HourOfDay
+        Counts counts;
+        int longestStretch = 0; // the longest of a single day
+    };
+
+    explicit RSIHistory(RSIActivityLog *log);
+
+    /** @returns the rollup of @p date, empty if nothing was logged. */
+    const DayRollup &day(const QDate &date);
+
+    /**
+     * Adds up the days from @p from to @p to, both included. Days and weeks
+     * without anything logged are left out, all 24 hours are always there.
+     */
+    QVector<Aggregate> query(const QDate &from, const QDate &to, Grouping grouping);
+
+    /** @returns the rollup of @p day, as read from the log. */
+    static DayRollup rollUp(const RSIActivityLog::Day &day);
+
+private:
+    RSIActivityLog *m_log;
+    QHash<QDate, DayRollup> m_rollups;
+    // The rollup of today, not kept as it keeps changing.
+    DayRollup m_today;
+};
+
+#endif // RSIBREAK_RSIHISTORY_H
@@ -0,0 +1,300 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiidlebackends.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+#include <QTextStream>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+static const QString LOGIND_SERVICE = QStringLiteral("org.freedesktop.login1");
+static const QString SESSION_INTERFACE = QStringLiteral("org.freedesktop.login1.Session");
+static const QString PROPERTIES_INTERFACE = QStringLiteral("org.freedesktop.DBus.Properties");
+static const QString IDLE_HINT = QStringLiteral("IdleHint");
+
+// @returns the object path of the logind session @p id, escaped like sd-bus does.
+static QString sessionPath(const QString &id)
+{
+    QString path = QStringLiteral("/org/freedesktop/login1/session/");
+    if (id.isEmpty()) {
+        return path + QLatin1Char('_');
+    }
+    const QByteArray bytes = id.toUtf8();
+    for (int i = 0; i < bytes.size(); ++i) {
+        const char c = bytes[i];
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (i > 0 && c >= '0' && c <= '9')) {
+            path += QLatin1Char(c);
+        } else {
+            path += QStringLiteral("_%1").arg(uchar(c), 2, 16, QLatin1Char('0'));
+        }
+    }
+    return path;
+}
+
+// -------------------- RSIIdleTimeLogind --------------------
+
+RSIIdleTimeLogind::RSIIdleTimeLogind(QObject *parent)
+    : RSIIdleTimeTracker(parent)
+{
+    // The session of this process, or the graphical one of the user. Its
+    // real path is needed for the change signals.
+    fetchProperties(QStringLiteral("/org/freedesktop/login1/session/auto"));
+}
+
+void RSIIdleTimeLogind::fetchProperties(const QString &path)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(LOGIND_SERVICE, path, PROPERTIES_INTERFACE, QStringLiteral("GetAll"));
+    message << SESSION_INTERFACE;
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &RSIIdleTimeLogind::onPropertiesFetched);
+}
+
+void RSIIdleTimeLogind::onPropertiesFetched(QDBusPendingCallWatcher *watcher)
+{
+    QDBusPendingReply<QVariantMap> reply = *watcher;
+    watcher->deleteLater();
+    if (reply.isError()) {
+        qWarning() << "Could not read the logind session:" << reply.error().message();
+        return;
+    }
+
+    const QVariantMap properties = reply.value();
+    if (m_sessionPath.isEmpty()) {
+        m_sessionPath = sessionPath(properties.value(QStringLiteral("Id")).toString());
+        const bool connected = QDBusConnection::systemBus().connect(LOGIND_SERVICE,
+                                                                    m_sessionPath,
+                                                                    PROPERTIES_INTERFACE,
+                                                                    QStringLiteral("PropertiesChanged"),
+                                                                    this,
+                                                                    SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+        if (!connected) {
+            qWarning() << "Could not follow the idle hint of" << m_sessionPath;
+        }
+    }
+    applyIdleHint(properties);
+}
+
+void RSIIdleTimeLogind::onPropertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated)
+{
+    if (interface != SESSION_INTERFACE) {
+        return;
+    }
+    if (changed.contains(IDLE_HINT)) {
+        applyIdleHint(changed);
+    } else if (invalidated.contains(IDLE_HINT)) {
+        fetchProperties(m_sessionPath);
+    }
+}
+
+void RSIIdleTimeLogind::applyIdleHint(const QVariantMap &properties)
+{
+    if (!properties.value(IDLE_HINT).toBool()) {
+        // No input times from logind, only that the user is back.
+        inputOngoing();
+        return;
+    }
+    // Microseconds on CLOCK_MONOTONIC, like RSIClockImpl.
+    const qint64 since = properties.value(QStringLiteral("IdleSinceHintMonotonic")).toLongLong() / 1000;
+    idleSince(since > 0 ? since : now());
+}
+
+#ifdef Q_OS_LINUX
+// -------------------- RSIIdleTimeEvdev --------------------
+
+static constexpr int LONG_BITS = 8 * sizeof(unsigned long);
+
+// @returns whether @p bit is set in the evdev bitmask @p bits.
+static bool testBit(const unsigned long *bits, const int bit)
+{
+    return bits[bit / LONG_BITS] & (1UL << (bit % LONG_BITS));
+}
+
+// @returns whether the absolute axes of @p fd move with the user, as on
+// touchpads, touchscreens and tablets, and not on their own, as on
+// accelerometers and other sensors.
+static bool hasPointerAxes(const int fd)
+{
+    unsigned long properties[INPUT_PROP_CNT / LONG_BITS + 1] = {};
+    ioctl(fd, EVIOCGPROP(sizeof(properties)), properties);
+    if (testBit(properties, INPUT_PROP_POINTER) || testBit(properties, INPUT_PROP_DIRECT)) {
+        return true;
+    }
+    // Older drivers only tell by their touch and tool buttons.
+    unsigned long keys[KEY_CNT / LONG_BITS + 1] = {};
+    ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys);
+    for (int key = BTN_TOOL_PEN; key <= BTN_TOOL_QUADTAP; ++key) {
+        if (testBit(keys, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RSIIdleTimeEvdev::RSIIdleTimeEvdev(QObject *parent)
+    : RSIIdleTimeTracker(parent)
+    , m_watchTimer(new QTimer(this))
+{
+    // Input is read out at once when the second is over.
+    m_watchTimer->setSingleShot(true);
+    m_watchTimer->setInterval(1000);
+    connect(m_watchTimer, &QTimer::timeout, this, [this]() {
+        readEvents();
+        for (const Device &device : std::as_const(m_devices)) {
+            device.notifier->setEnabled(true);
+        }
+    });
+
+    const QDir input(QStringLiteral("/dev/input"));
+    const QStringList names = input.entryList({QStringLiteral("event*")}, QDir::System);
+    for (const QString &name : names) {
+        const int fd = ::open(QFile::encodeName(input.filePath(name)).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        // Devices with nothing but sensor axes, like accelerometers, would
+        // keep the user active.
+        unsigned long types[EV_CNT / LONG_BITS + 1] = {};
+        ioctl(fd, EVIOCGBIT(0, sizeof(types)), types);
+        const bool absInput = testBit(types, EV_ABS) && hasPointerAxes(fd);
+        if (!testBit(types, EV_KEY) && !testBit(types, EV_REL) && !absInput) {
+            ::close(fd);
+            continue;
+        }
+
+        // Event times on the clock the timeouts are measured with.
+        int clock = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clock);
+
+        QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, [this]() {
+            readEvents();
+            for (const Device &device : std::as_const(m_devices)) {
+                device.notifier->setEnabled(false);
+            }
+            m_watchTimer->start();
+        });
+        m_devices.append({notifier, absInput});
+    }
+    if (m_devices.isEmpty()) {
+        qWarning() << "No readable input devices in" << input.path() << "no idle detection";
+    }
+}
+
+RSIIdleTimeEvdev::~RSIIdleTimeEvdev()
+{
+    for (const Device &device : std::as_const(m_devices)) {
+        const int fd = device.notifier->socket();
+        delete device.notifier;
+        ::close(fd);
+    }
+}
+
+void RSIIdleTimeEvdev::refresh()
+{
+    readEvents();
+}
+
+void RSIIdleTimeEvdev::readEvents()
+{
+    qint64 lastInput = -1;
+    quint32 presses = 0;
+    input_event events[64];
+    for (const Device &device : std::as_const(m_devices)) {
+        ssize_t bytes;
+        while ((bytes = ::read(device.notifier->socket(), events, sizeof(events))) > 0) {
+            for (size_t i = 0; i < bytes / sizeof(input_event); ++i) {
+                const input_event &event = events[i];
+                if (event.type == EV_KEY || event.type == EV_REL || (event.type == EV_ABS && device.absIsInput)) {
+                    lastInput = std::max<qint64>(lastInput, event.input_event_sec * 1000LL + event.input_event_usec / 1000);
+                    m_moving = m_moving || event.type != EV_KEY;
+                    presses += event.type == EV_KEY && event.value == 1;
+                } else if (event.type == EV_SYN && event.code == SYN_REPORT && m_moving) {
+                    m_moving = false;
+                    ++m_motionReports;
+                }
+            }
+        }
+    }
+    if (lastInput >= 0) {
+        countInput(presses + m_motionReports / 32);
+        m_motionReports %= 32;
+        inputAt(lastInput);
+    }
+}
+#endif
+
+// -------------------- RSIIdleTimeReplay --------------------
+
+RSIIdleTimeReplay::RSIIdleTimeReplay(const QString &path, QObject *parent)
+    : RSIIdleTimeTracker(parent)
+    , m_startMs(now())
+    , m_replayTimer(new QTimer(this))
+{
+    m_replayTimer->setSingleShot(true);
+    m_replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_replayTimer, &QTimer::timeout, this, &RSIIdleTimeReplay::replay);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Could not read the idle replay" << path << file.errorString();
+        return;
+    }
+
+    QTextStream in(&file);
+    QString line;
+    int lineNumber = 0;
+    while (in.readLineInto(&line)) {
+        ++lineNumber;
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+        const QStringList fields = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        bool ok = false;
+        const qint64 second = fields.value(0).toLongLong(&ok);
+        if (fields.size() != 2 || !ok || (!m_changes.isEmpty() && second < m_changes.constLast().second)) {
+            qWarning() << "Skipping line" << lineNumber << "of the idle replay" << path;
+            continue;
+        }
+        if (fields[1] == QLatin1String("idle") || fields[1] == QLatin1String("active")) {
+            m_changes.append({second, fields[1] == QLatin1String("active")});
+        }
+    }
+    replay();
+}
+
+void RSIIdleTimeReplay::replay()
+{
+    const qint64 current = now();
+    for (; m_next < m_changes.size(); ++m_next) {
+        const Change &change = m_changes[m_next];
+        const qint64 due = m_startMs + change.second * 1000;
+        if (due > current) {
+            m_replayTimer->start(due - current);
+            return;
+        }
+        if (change.active) {
+            inputOngoing();
+        } else {
+            idleSince(due);
+        }
+    }
+}
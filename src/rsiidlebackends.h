@@ -0,0 +1,121 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIIDLEBACKENDS_H
+#define RSIBREAK_RSIIDLEBACKENDS_H
+
+#include <QVariantMap>
+#include <QVector>
+
+#include "rsiidletime.h"
+
+class QDBusPendingCallWatcher;
+class QSocketNotifier;
+
+/**
+ * Idle detection from the IdleHint of the logind session. The hint is set
+ * by the desktop after its own idle delay, so timeouts shorter than that
+ * are reported late, by as much as the latency shows.
+ */
+class RSIIdleTimeLogind : public RSIIdleTimeTracker
+{
+    Q_OBJECT
+
+public:
+    explicit RSIIdleTimeLogind(QObject *parent = nullptr);
+    ~RSIIdleTimeLogind() override = default;
+
+private slots:
+    void onPropertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated);
+    void onPropertiesFetched(QDBusPendingCallWatcher *watcher);
+
+private:
+    // Asks for the properties of the session again.
+    void fetchProperties(const QString &path);
+    // Applies IdleHint and IdleSinceHintMonotonic from @p properties.
+    void applyIdleHint(const QVariantMap &properties);
+
+    // The object path of our session, once known.
+    QString m_sessionPath;
+};
+
+#ifdef Q_OS_LINUX
+/**
+ * Idle detection from the input devices in /dev/input, for sessions
+ * without a desktop to ask, like kiosks. It needs read access to them,
+ * usually through the input group. Devices plugged in later are not seen.
+ * Absolute axes only count as input on pointing and touch devices, the
+ * ones of sensors like accelerometers are ignored.
+ *
+ * The devices are watched from the event loop. After input they are left
+ * alone for a second and then read out at once, so that continuous input
+ * wakes up at most about once a second.
+ *
+ * Key and button presses count as one input event each, pointer motion as
+ * one per 32 reports, so that moving the mouse weighs about as much as
+ * slow typing.
+ */
+class RSIIdleTimeEvdev : public RSIIdleTimeTracker
+{
+    Q_OBJECT
+
+public:
+    explicit RSIIdleTimeEvdev(QObject *parent = nullptr);
+    ~RSIIdleTimeEvdev() override;
+
+    bool countsInput() const override
+    {
+        return true;
+    }
+
+protected:
+    void refresh() override;
+
+private:
+    // Reads all pending events, and reports the last input.
+    void readEvents();
+
+    struct Device {
+        QSocketNotifier *notifier;
+        // A touchpad, touchscreen or tablet, whose absolute axes are input.
+        bool absIsInput;
+    };
+    QVector<Device> m_devices;
+    QTimer *m_watchTimer;
+
+    // Whether the current report moved the pointer, and how many did.
+    bool m_moving = false;
+    quint32 m_motionReports = 0;
+};
+#endif
+
+/**
+ * Replays idleness and input from a file, with one "<second> <idle|active>"
+ * line per change, in seconds from the creation of the backend. Lines
+ * starting with # are comments, the other actions of the simulator traces
+ * are skipped. Meant for trying out the timer without a desktop.
+ */
+class RSIIdleTimeReplay : public RSIIdleTimeTracker
+{
+    Q_OBJECT
+
+public:
+    explicit RSIIdleTimeReplay(const QString &path, QObject *parent = nullptr);
+    ~RSIIdleTimeReplay() override = default;
+
+private:
+    // Applies the changes due, and waits for the next one.
+    void replay();
+
+    struct Change {
+        qint64 second;
+        bool active;
+    };
+    QVector<Change> m_changes;
+    int m_next = 0;
+    qint64 m_startMs;
+    QTimer *m_replayTimer;
+};
+
+#endif // RSIBREAK_RSIIDLEBACKENDS_H
@@ -3,6 +3,76 @@
 */
 
 #include "rsiidletime.h"
+#include "rsiclock.h"
+#include "rsiidlebackends.h"
+
+#include <QDebug>
+#include <QTimer>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <algorithm>
+#include <climits>
+
+// The backends by name, the first one is the default.
+static const struct {
+    const char *name;
+    RSIIdleTime *(*create)(QObject *parent);
+} backendTable[] = {
+    {"kidletime",
+     [](QObject *parent) -> RSIIdleTime * {
+         return new RSIIdleTimeImpl(parent);
+     }},
+    {"logind",
+     [](QObject *parent) -> RSIIdleTime * {
+         return new RSIIdleTimeLogind(parent);
+     }},
+#ifdef Q_OS_LINUX
+    {"evdev",
+     [](QObject *parent) -> RSIIdleTime * {
+         return new RSIIdleTimeEvdev(parent);
+     }},
+#endif
+    {"replay",
+     [](QObject *parent) -> RSIIdleTime * {
+         const KConfigGroup config = KSharedConfig::openConfig()->group("General Settings");
+         return new RSIIdleTimeReplay(config.readEntry("IdleReplayFile", QString()), parent);
+     }},
+};
+
+// -------------------- RSIIdleTime --------------------
+
+RSIIdleTime *RSIIdleTime::create(const QString &name, QObject *parent)
+{
+    auto backend = std::find_if(std::begin(backendTable), std::end(backendTable), [&name](const auto &backend) {
+        return name == QLatin1String(backend.name);
+    });
+    if (backend == std::end(backendTable)) {
+        qWarning() << "Unknown idle backend" << name << "using" << backendTable[0].name;
+        backend = std::begin(backendTable);
+    }
+
+    RSIIdleTime *idleTime = backend->create(parent);
+    idleTime->setObjectName(QLatin1String(backend->name));
+    return idleTime;
+}
+
+QStringList RSIIdleTime::backends()
+{
+    QStringList names;
+    for (const auto &backend : backendTable) {
+        names << QLatin1String(backend.name);
+    }
+    return names;
+}
+
+void RSIIdleTime::Latency::record(const qint64 ms)
+{
+    ++count;
+    totalMs += ms;
+    maxMs = std::max(maxMs, ms);
+}
 
 // -------------------- RSIIdleTimeImpl --------------------
 
@@ -34,12 +104,136 @@ void RSIIdleTimeImpl::catchNextResumeEvent()
 void RSIIdleTimeImpl::onTimeoutReached(int identifier, int msec)
 {
     Q_UNUSED(identifier)
+    m_latency.record(std::max(0, KIdleTime::instance()->idleTime() - msec));
     emit idleTimeoutReached(msec);
 
     // Re-register for resume event to track when user becomes active
     KIdleTime::instance()->catchNextResumeEvent();
 }
 
+// -------------------- RSIIdleTimeTracker --------------------
+
+RSIIdleTimeTracker::RSIIdleTimeTracker(QObject *parent)
+    : RSIIdleTime(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &RSIIdleTimeTracker::check);
+
+    // Until the backend knows better, idle from now on.
+    idleSince(now());
+}
+
+int RSIIdleTimeTracker::addIdleTimeout(int msec)
+{
+    const int id = m_nextId++;
+    m_timeouts.insert(id, msec);
+    schedule();
+    return id;
+}
+
+void RSIIdleTimeTracker::removeAllIdleTimeouts()
+{
+    m_timeouts.clear();
+    m_timer->stop();
+}
+
+void RSIIdleTimeTracker::catchNextResumeEvent()
+{
+    m_catchResume = true;
+}
+
+void RSIIdleTimeTracker::inputAt(qint64 ms)
+{
+    // Input while nothing is reported costs only this, the timer finds
+    // out about it when it fires.
+    m_ongoing = false;
+    m_lastInputMs = std::max(m_lastInputMs, ms);
+    if (m_reachedMs > 0) {
+        resume();
+        schedule();
+    } else if (!m_timer->isActive()) {
+        schedule();
+    }
+}
+
+void RSIIdleTimeTracker::inputOngoing()
+{
+    m_ongoing = true;
+    if (m_reachedMs > 0) {
+        resume();
+    }
+    m_timer->stop();
+}
+
+void RSIIdleTimeTracker::idleSince(qint64 ms)
+{
+    m_ongoing = false;
+    m_lastInputMs = ms;
+    // Timeouts behind already are reported right away, as late as they are.
+    schedule();
+}
+
+qint64 RSIIdleTimeTracker::now() const
+{
+    return RSIClockImpl().monotonicMSecs();
+}
+
+void RSIIdleTimeTracker::refresh()
+{
+}
+
+void RSIIdleTimeTracker::resume()
+{
+    m_reachedMs = 0;
+    if (m_catchResume) {
+        m_catchResume = false;
+        emit resumingFromIdle();
+    }
+}
+
+void RSIIdleTimeTracker::check()
+{
+    refresh();
+    if (m_ongoing) {
+        return;
+    }
+
+    const qint64 idleMs = now() - m_lastInputMs;
+    // A copy, as the receivers may add or remove timeouts.
+    QList<int> reached;
+    for (const int msec : std::as_const(m_timeouts)) {
+        if (msec > m_reachedMs && msec <= idleMs) {
+            reached.append(msec);
+        }
+    }
+    std::sort(reached.begin(), reached.end());
+    for (const int msec : std::as_const(reached)) {
+        m_latency.record(idleMs - msec);
+        m_reachedMs = std::max(m_reachedMs, msec);
+        // Like KIdleTime, the next input after a timeout is reported.
+        m_catchResume = true;
+        emit idleTimeoutReached(msec);
+    }
+    schedule();
+}
+
+void RSIIdleTimeTracker::schedule()
+{
+    int next = INT_MAX;
+    for (const int msec : std::as_const(m_timeouts)) {
+        if (msec > m_reachedMs) {
+            next = std::min(next, msec);
+        }
+    }
+    if (m_ongoing || next == INT_MAX) {
+        m_timer->stop();
+        return;
+    }
+    m_timer->start(std::max<qint64>(m_lastInputMs + next - now(), 0));
+}
+
 // -------------------- RSIIdleTimeFake --------------------
 
 int RSIIdleTimeFake::addIdleTimeout(int msec)
@@ -59,6 +253,13 @@ void RSIIdleTimeFake::catchNextResumeEvent()
     // No-op for fake implementation
 }
 
+QList<int> RSIIdleTimeFake::idleTimeouts() const
+{
+    QList<int> timeouts = m_timeouts.values();
+    std::sort(timeouts.begin(), timeouts.end());
+    return timeouts;
+}
+
 void RSIIdleTimeFake::simulateIdleTimeout(int msec)
 {
     emit idleTimeoutReached(msec);
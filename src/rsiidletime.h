@@ -7,9 +7,18 @@
 
 #include <KIdleTime>
 
+#include <atomic>
+
+class QTimer;
+
 /**
  * Abstract interface for idle time detection.
  * Uses an event-based approach compatible with Wayland.
+ *
+ * The backends are chosen by name with create(), from the IdleBackend entry
+ * of the General Settings. Every backend measures how late it reports idle
+ * timeouts, see latency(). Backends which see single input events count
+ * them as well, for the input intensity metering of RSITimer.
  */
 class RSIIdleTime : public QObject
 {
@@ -22,6 +31,34 @@ public:
     }
     ~RSIIdleTime() override = default;
 
+    /**
+     * @returns the backend called @p name, or the KIdleTime one if there is
+     * no such backend. The backend name is set as its objectName().
+     */
+    static RSIIdleTime *create(const QString &name, QObject *parent = nullptr);
+
+    /** @returns the names of the backends create() knows. */
+    static QStringList backends();
+
+    // How late idle timeouts were reported, in milliseconds after they were reached.
+    struct Latency {
+        int count = 0;
+        qint64 totalMs = 0;
+        qint64 maxMs = 0;
+
+        void record(const qint64 ms);
+        qint64 averageMs() const
+        {
+            return count ? totalMs / count : 0;
+        }
+    };
+
+    /** @returns the latency so far, as reported by the idleBackend() D-Bus method. */
+    const Latency &latency() const
+    {
+        return m_latency;
+    }
+
     /**
      * Register a timeout to be notified when idle for msec milliseconds.
      * @param msec Milliseconds of idle time to trigger notification
@@ -39,6 +76,22 @@ public:
      */
     virtual void catchNextResumeEvent() = 0;
 
+    /**
+     * @returns whether input events are counted, see takeInputEvents().
+     */
+    virtual bool countsInput() const
+    {
+        return false;
+    }
+
+    /**
+     * @returns the input events counted since the last call.
+     */
+    quint32 takeInputEvents()
+    {
+        return m_inputEvents.exchange(0, std::memory_order_relaxed);
+    }
+
 signals:
     /**
      * Emitted when a registered idle timeout is reached.
@@ -50,6 +103,18 @@ signals:
      * Emitted when user activity resumes after being idle.
      */
     void resumingFromIdle();
+
+protected:
+    // Counts @p events input events, without locking or allocating.
+    void countInput(const quint32 events)
+    {
+        m_inputEvents.fetch_add(events, std::memory_order_relaxed);
+    }
+
+    Latency m_latency;
+
+private:
+    std::atomic<quint32> m_inputEvents{0};
 };
 
 /**
@@ -74,6 +139,57 @@ private:
     QHash<int, int> m_timeouts; // id -> msec mapping
 };
 
+/**
+ * Base for backends which only learn about input, or about idleness since
+ * some time, and work out the idle timeouts themselves with a single timer.
+ * Continuous input costs no more than a timestamp, the timer only runs
+ * while a timeout is ahead.
+ */
+class RSIIdleTimeTracker : public RSIIdleTime
+{
+    Q_OBJECT
+
+public:
+    explicit RSIIdleTimeTracker(QObject *parent = nullptr);
+    ~RSIIdleTimeTracker() override = default;
+
+    int addIdleTimeout(int msec) override;
+    void removeAllIdleTimeouts() override;
+    void catchNextResumeEvent() override;
+
+protected:
+    // There was input at monotonic time @p ms, and none since.
+    void inputAt(qint64 ms);
+    // Input goes on until inputAt() or idleSince() says otherwise.
+    void inputOngoing();
+    // There was no input since monotonic time @p ms.
+    void idleSince(qint64 ms);
+
+    // @returns the monotonic time in milliseconds.
+    qint64 now() const;
+
+    // Called before the timeouts are checked, to catch up on input.
+    virtual void refresh();
+
+private:
+    // Reports the timeouts reached, and arms the timer for the next one.
+    void check();
+    // Arms the timer for the next timeout, or stops it.
+    void schedule();
+    // Sends resumingFromIdle() if it was asked for.
+    void resume();
+
+    QTimer *m_timer;
+    QHash<int, int> m_timeouts; // id -> msec mapping
+    int m_nextId = 1;
+
+    bool m_ongoing = true;
+    qint64 m_lastInputMs = 0;
+    // The longest timeout reported since the last input.
+    int m_reachedMs = 0;
+    bool m_catchResume = false;
+};
+
 /**
  * Fake implementation for testing.
  */
@@ -91,10 +207,19 @@ public:
     int addIdleTimeout(int msec) override;
     void removeAllIdleTimeouts() override;
     void catchNextResumeEvent() override;
+    bool countsInput() const override
+    {
+        return true;
+    }
 
     // Test helper methods
+    QList<int> idleTimeouts() const;
     void simulateIdleTimeout(int msec);
     void simulateResumeFromIdle();
+    void simulateInput(quint32 events)
+    {
+        countInput(events);
+    }
 
 private:
     int m_nextId = 1;
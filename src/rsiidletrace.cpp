@@ -0,0 +1,145 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiidletrace.h"
+
+#include <QDebug>
+#include <QtEndian>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "rsiclock.h"
+#include "rsiidletime.h"
+
+static constexpr int headerSize = 4 + 1 + 8;
+
+// @returns the end of the varint written to @p out.
+static char *writeVarint(char *out, quint64 value)
+{
+    while (value >= 0x80) {
+        *out++ = char((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    *out++ = char(value);
+    return out;
+}
+
+// @returns false at the end of @p data or on an overlong varint.
+static bool readVarint(const char *&in, const char *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in == end) {
+            return false;
+        }
+        const quint8 byte = quint8(*in++);
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RSIIdleTrace::isTrace(QIODevice *device)
+{
+    const QByteArray header = device->peek(5);
+    return header.size() == 5 && header.startsWith(magic) && quint8(header[4]) == version;
+}
+
+bool RSIIdleTrace::read(QIODevice *device, QVector<Event> &events, QString *error)
+{
+    const QByteArray data = device->readAll();
+    if (data.size() < headerSize || !data.startsWith(magic)) {
+        *error = QStringLiteral("not an idle trace");
+        return false;
+    }
+    if (quint8(data[4]) != version) {
+        *error = QStringLiteral("unsupported idle trace version %1").arg(quint8(data[4]));
+        return false;
+    }
+
+    const char *in = data.constData() + headerSize;
+    const char *end = data.constData() + data.size();
+    qint64 ms = 0;
+    while (in != end) {
+        quint64 value;
+        if (!readVarint(in, end, value)) {
+            *error = QStringLiteral("truncated at event %1").arg(events.size());
+            return false;
+        }
+        ms += qint64(value >> 1);
+        if (value & 1) {
+            events.append({ms, Kind::Resume, 0});
+            continue;
+        }
+        quint64 msec;
+        if (!readVarint(in, end, msec) || msec > quint64(INT_MAX)) {
+            *error = QStringLiteral("truncated at event %1").arg(events.size());
+            return false;
+        }
+        events.append({ms, Kind::IdleTimeout, int(msec)});
+    }
+    return true;
+}
+
+RSIIdleTraceWriter::RSIIdleTraceWriter(const QString &fileName, const RSIClock *clock, QObject *parent)
+    : QObject(parent)
+    , m_file(fileName)
+    , m_clock(clock)
+    , m_lastMs(clock->monotonicMSecs())
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not capture the idle notifications to" << fileName << m_file.errorString();
+        return;
+    }
+
+    char header[headerSize];
+    memcpy(header, RSIIdleTrace::magic, 4);
+    header[4] = char(RSIIdleTrace::version);
+    qToLittleEndian<qint64>(m_lastMs, header + 5);
+    m_file.write(header, headerSize);
+    m_file.flush();
+}
+
+RSIIdleTraceWriter::~RSIIdleTraceWriter()
+{
+}
+
+void RSIIdleTraceWriter::watch(RSIIdleTime *idleTime)
+{
+    connect(idleTime, &RSIIdleTime::idleTimeoutReached, this, &RSIIdleTraceWriter::onIdleTimeoutReached, Qt::UniqueConnection);
+    connect(idleTime, &RSIIdleTime::resumingFromIdle, this, &RSIIdleTraceWriter::onResumingFromIdle, Qt::UniqueConnection);
+}
+
+void RSIIdleTraceWriter::onIdleTimeoutReached(int msec)
+{
+    write(RSIIdleTrace::Kind::IdleTimeout, msec);
+}
+
+void RSIIdleTraceWriter::onResumingFromIdle()
+{
+    write(RSIIdleTrace::Kind::Resume, 0);
+}
+
+void RSIIdleTraceWriter::write(const RSIIdleTrace::Kind kind, const int msec)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    const qint64 now = m_clock->monotonicMSecs();
+    const quint64 delta = quint64(std::max<qint64>(now - m_lastMs, 0));
+    m_lastMs = std::max(m_lastMs, now);
+
+    char record[20];
+    char *end = writeVarint(record, delta << 1 | (kind == RSIIdleTrace::Kind::Resume ? 1 : 0));
+    if (kind == RSIIdleTrace::Kind::IdleTimeout) {
+        end = writeVarint(end, quint64(std::max(msec, 0)));
+    }
+    m_file.write(record, end - record);
+    m_file.flush();
+}
@@ -0,0 +1,94 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIIDLETRACE_H
+#define RSIBREAK_RSIIDLETRACE_H
+
+#include <QFile>
+#include <QObject>
+#include <QVector>
+
+class QIODevice;
+class RSIClock;
+class RSIIdleTime;
+
+/**
+ * @class RSIIdleTrace
+ * The binary format of captured idle notifications, as written by
+ * RSIIdleTraceWriter and replayed by rsibreak-sim.
+ *
+ * A trace starts with the magic "RSIT", a version byte and the monotonic
+ * time of the capture start in milliseconds, 8 bytes little endian. Each
+ * notification follows as a LEB128 varint of the milliseconds since the
+ * previous one, shifted left by one, with the lowest bit set for
+ * resumingFromIdle(). An idleTimeoutReached() is followed by a varint of
+ * its timeout in milliseconds. A day of notifications takes a few hundred
+ * bytes.
+ */
+class RSIIdleTrace
+{
+public:
+    enum class Kind {
+        IdleTimeout, // idleTimeoutReached(msec)
+        Resume // resumingFromIdle()
+    };
+
+    struct Event {
+        qint64 ms; // since the capture start
+        Kind kind;
+        int msec; // the timeout reached, 0 for resumes
+    };
+
+    // @returns whether @p device looks like a trace, without reading from it.
+    static bool isTrace(QIODevice *device);
+
+    /**
+      Reads all events of the trace in @p device.
+      @returns false and sets @p error if it is not a trace or truncated.
+    */
+    static bool read(QIODevice *device, QVector<Event> &events, QString *error);
+
+    static constexpr char magic[] = "RSIT";
+    static constexpr quint8 version = 1;
+};
+
+/**
+ * @class RSIIdleTraceWriter
+ * Captures the notifications of an idle backend with the monotonic time
+ * they arrived at, to reproduce timing problems offline. Every event is
+ * flushed right away, they come a few times a minute at most.
+ */
+class RSIIdleTraceWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+      Starts a new trace in @p fileName, replacing what was there.
+      @param clock The clock of the timer, which must outlive the writer.
+    */
+    RSIIdleTraceWriter(const QString &fileName, const RSIClock *clock, QObject *parent = nullptr);
+    ~RSIIdleTraceWriter() override;
+
+    QString fileName() const
+    {
+        return m_file.fileName();
+    }
+
+    // Captures the notifications of @p idleTime, too. Safe to call again.
+    void watch(RSIIdleTime *idleTime);
+
+private slots:
+    void onIdleTimeoutReached(int msec);
+    void onResumingFromIdle();
+
+private:
+    void write(const RSIIdleTrace::Kind kind, const int msec);
+
+    QFile m_file;
+    const RSIClock *m_clock;
+    qint64 m_lastMs;
+};
+
+#endif // RSIBREAK_RSIIDLETRACE_H
@@ -16,11 +16,12 @@
 
 #include <KColorScheme>
 #include <KConfigGroup>
-#include <KFormat>
 #include <KLocalizedString>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 
+#include "rsiglobals.h"
+
 RSIRelaxPopup::RSIRelaxPopup(QWidget *parent)
     : QObject(parent)
     , m_wasShown(false)
@@ -91,7 +92,7 @@ void RSIRelaxPopup::relax(int n, bool bigBreakNext)
     }
 
     if (n > 0) {
-        QString text = i18n("Please relax for %1", KFormat().formatSpelloutDuration(n * 1000));
+        QString text = i18n("Please relax for %1", RSIGlobals::instance()->formatSeconds(n));
 
         if (bigBreakNext)
             text.append('\n' + i18n("Note: next break is a big break"));
@@ -108,6 +109,16 @@ void RSIRelaxPopup::relax(int n, bool bigBreakNext)
     }
 }
 
+void RSIRelaxPopup::setSnapshot(const RSITimerSnapshot &snapshot)
+{
+    // Patience only runs out while the user keeps working, which relax() flashes for.
+    if (snapshot.relaxLeft != m_snapshot.relaxLeft || snapshot.patienceLeft != m_snapshot.patienceLeft
+        || snapshot.nextBreakIsBig != m_snapshot.nextBreakIsBig) {
+        relax(snapshot.relaxLeft, snapshot.nextBreakIsBig);
+    }
+    m_snapshot = snapshot;
+}
+
 void RSIRelaxPopup::flash()
 {
     if (!m_useFlash)
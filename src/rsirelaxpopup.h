@@ -12,6 +12,8 @@
 #include <QLabel>
 #include <passivepopup.h>
 
+#include "rsitimersnapshot.h"
+
 class QLabel;
 class QPushButton;
 class QProgressBar;
@@ -40,6 +42,12 @@ public slots:
     */
     void relax(int n, bool bigBreakNext);
 
+    /**
+      Calls relax() if the suggested break in @p snapshot differs from the
+      one of the last snapshot, or if the user worked on through it.
+    */
+    void setSnapshot(const RSITimerSnapshot &snapshot);
+
     /**
       Reread config
     */
@@ -88,6 +96,7 @@ private:
     QPushButton *m_lockbutton;
     QPushButton *m_skipbutton;
     QPushButton *m_postponebutton;
+    RSITimerSnapshot m_snapshot;
 };
 
 #endif /* RSIRELAXPOPUP_H */
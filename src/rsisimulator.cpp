@@ -0,0 +1,264 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsisimulator.h"
+
+#include <QIODevice>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include <algorithm>
+#include <climits>
+
+#include "rsiclock.h"
+#include "rsiidletime.h"
+#include "rsiidletrace.h"
+
+RSISimulator::RSISimulator(const QVector<int> &intervals, const bool usePopup, const bool useIdleTimers, QTextStream &out)
+    : QObject(nullptr)
+    , m_idleTime(new RSIIdleTimeFake())
+    , m_clock(new RSIClockFake())
+    , m_out(out)
+{
+    // The timer owns both, and only ever gets whole seconds from the clock.
+    m_timer.reset(new RSITimer(std::unique_ptr<RSIIdleTime>(m_idleTime), intervals, usePopup, useIdleTimers, std::unique_ptr<RSIClock>(m_clock)));
+    m_lastState = m_timer->m_state;
+    m_wasReset.fill(true, m_timer->m_breakTiers.size());
+}
+
+RSISimulator::~RSISimulator()
+{
+}
+
+bool RSISimulator::readTrace(QIODevice *device, QVector<TraceEvent> &events, QString *error)
+{
+    static const QMap<QString, TraceAction> actions = {
+        {QStringLiteral("idle"), TraceAction::Idle},
+        {QStringLiteral("active"), TraceAction::Active},
+        {QStringLiteral("skip"), TraceAction::Skip},
+        {QStringLiteral("postpone"), TraceAction::Postpone},
+        {QStringLiteral("lock"), TraceAction::Lock},
+    };
+
+    QTextStream in(device);
+    QString line;
+    int lineNumber = 0;
+    qint64 last = 0;
+    while (in.readLineInto(&line)) {
+        ++lineNumber;
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+
+        const QStringList fields = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        bool ok = false;
+        const qint64 second = fields.value(0).toLongLong(&ok);
+        if (fields.size() != 2 || !ok || !actions.contains(fields[1])) {
+            *error = QStringLiteral("line %1: expected \"<second> <action>\"").arg(lineNumber);
+            return false;
+        }
+        if (second < last) {
+            *error = QStringLiteral("line %1: events are not in order").arg(lineNumber);
+            return false;
+        }
+        events.append({second, actions.value(fields[1])});
+        last = second;
+    }
+    return true;
+}
+
+bool RSISimulator::readIdleTrace(QIODevice *device, QVector<TraceEvent> &events, QString *error)
+{
+    QVector<RSIIdleTrace::Event> captured;
+    if (!RSIIdleTrace::read(device, captured, error)) {
+        return false;
+    }
+    events.reserve(events.size() + captured.size());
+    for (const RSIIdleTrace::Event &event : std::as_const(captured)) {
+        if (event.kind == RSIIdleTrace::Kind::Resume) {
+            events.append({event.ms / 1000, TraceAction::Active});
+        } else {
+            events.append({event.ms / 1000, TraceAction::Idle, event.msec});
+        }
+    }
+    return true;
+}
+
+QVector<RSISimulator::TraceEvent> RSISimulator::officeTrace(const int days, const quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QVector<TraceEvent> events;
+    events.append({0, TraceAction::Idle});
+
+    for (int day = 0; day < days; ++day) {
+        if (day % 7 >= 5) {
+            continue;
+        }
+        const qint64 dayStart = day * 24 * 60 * 60LL;
+        const qint64 lunch = dayStart + 12 * 60 * 60 + random.bounded(30 * 60);
+        const qint64 end = dayStart + 17 * 60 * 60 + random.bounded(60 * 60);
+        qint64 second = dayStart + 9 * 60 * 60 + random.bounded(30 * 60);
+        bool hadLunch = false;
+        while (second < end) {
+            // Work for 2 to 40 minutes, then pause for up to 10 minutes.
+            events.append({second, TraceAction::Active});
+            second += 2 * 60 + random.bounded(38 * 60);
+            events.append({second, TraceAction::Idle});
+            if (!hadLunch && second >= lunch) {
+                second += 45 * 60 + random.bounded(30 * 60);
+                hadLunch = true;
+            } else {
+                second += 30 + random.bounded(10 * 60);
+            }
+        }
+    }
+    return events;
+}
+
+void RSISimulator::run(const QVector<TraceEvent> &trace, const qint64 duration)
+{
+    m_out << "# second\tevent\tbreak\tseconds\n";
+    for (const TraceEvent &event : trace) {
+        advanceTo(event.second);
+        apply(event);
+    }
+    advanceTo(duration);
+    m_out.flush();
+}
+
+void RSISimulator::advanceTo(const qint64 second)
+{
+    while (m_now < second) {
+        const qint64 step = std::min(second - m_now, ticksToNextTransition());
+        m_clock->advance(step * 1000);
+        m_now += step;
+        m_timer->catchUp();
+        checkTransitions();
+    }
+}
+
+qint64 RSISimulator::ticksToNextTransition() const
+{
+    const int idleSeconds = m_timer->idleSecondsAt((m_now + 1) * 1000LL);
+    qint64 ticks = m_timer->ticksWithoutTransition(idleSeconds) + 1LL;
+
+    // Idle resets do not change the state, but go on the timeline as well.
+    if (m_timer->m_state == RSITimer::TimerState::Monitoring) {
+        for (const RSITimer::BreakTier &breakTier : m_timer->m_breakTiers) {
+            if (breakTier.counter.isReset()) {
+                continue;
+            }
+            const long long resetAt = breakTier.counter.ticksToReset(idleSeconds, m_timer->m_isIdle);
+            if (resetAt != LLONG_MAX) {
+                ticks = std::min<qint64>(ticks, resetAt + 1);
+            }
+        }
+    }
+
+    // catchUp() takes the ticks as an int.
+    return std::clamp<qint64>(ticks, 1, INT_MAX / 2);
+}
+
+void RSISimulator::apply(const TraceEvent &event)
+{
+    const bool inBreak = m_timer->m_state == RSITimer::TimerState::Suggesting || m_timer->m_state == RSITimer::TimerState::Resting;
+
+    switch (event.action) {
+    case TraceAction::Idle:
+        // Threshold timeouts reset counters and end breaks themselves.
+        m_idleTime->simulateIdleTimeout(event.idleMsec);
+        checkTransitions();
+        return;
+    case TraceAction::Active:
+        m_idleTime->simulateResumeFromIdle();
+        checkTransitions();
+        return;
+    case TraceAction::Skip:
+        // There is nothing to skip or postpone outside of a break.
+        if (inBreak) {
+            report(QStringLiteral("skip"), breakKind());
+            m_timer->skipBreak();
+        }
+        break;
+    case TraceAction::Postpone:
+        if (inBreak) {
+            report(QStringLiteral("postpone"), breakKind());
+            m_timer->postponeBreak();
+        }
+        break;
+    case TraceAction::Lock:
+        report(QStringLiteral("lock"));
+        m_timer->slotLock();
+        break;
+    }
+
+    // User actions end breaks, that is not a transition of its own.
+    m_lastState = m_timer->m_state;
+    for (int i = 0; i < m_wasReset.size(); ++i) {
+        m_wasReset[i] = m_timer->m_breakTiers[i].counter.isReset();
+    }
+}
+
+void RSISimulator::checkTransitions()
+{
+    const RSITimer::TimerState state = m_timer->m_state;
+
+    if (state != m_lastState) {
+        const QString duration = QString::number(m_timer->m_pauseCounter.getDelayTicks());
+        switch (state) {
+        case RSITimer::TimerState::Suggesting:
+            report(QStringLiteral("suggest"), breakKind() + QLatin1Char('\t') + duration);
+            break;
+        case RSITimer::TimerState::Resting:
+            report(QStringLiteral("rest"), breakKind() + QLatin1Char('\t') + duration);
+            break;
+        case RSITimer::TimerState::Monitoring:
+            report(QStringLiteral("break-end"));
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (int i = 0; i < m_wasReset.size(); ++i) {
+        const RSITimer::BreakTier &breakTier = m_timer->m_breakTiers[i];
+        const bool isReset = breakTier.counter.isReset();
+        if (state == m_lastState && state == RSITimer::TimerState::Monitoring && !m_wasReset[i] && isReset) {
+            report(QStringLiteral("idle-reset"), tierName(breakTier.tier));
+        }
+        m_wasReset[i] = isReset;
+    }
+    m_lastState = state;
+}
+
+QString RSISimulator::breakKind() const
+{
+    if (m_timer->m_breakIndex < 0) {
+        return QString();
+    }
+    return tierName(m_timer->m_breakTiers[m_timer->m_breakIndex].tier);
+}
+
+QString RSISimulator::tierName(const int tier)
+{
+    switch (tier) {
+    case RSITimer::TINY_TIER:
+        return QStringLiteral("tiny");
+    case RSITimer::BIG_TIER:
+        return QStringLiteral("big");
+    default:
+        return QStringLiteral("tier%1").arg(tier);
+    }
+}
+
+void RSISimulator::report(const QString &event, const QString &detail)
+{
+    m_out << m_now << '\t' << event;
+    if (!detail.isEmpty()) {
+        m_out << '\t' << detail;
+    }
+    m_out << '\n';
+    m_counts[event]++;
+}
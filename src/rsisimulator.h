@@ -0,0 +1,119 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSISIMULATOR_H
+#define RSIBREAK_RSISIMULATOR_H
+
+#include <QMap>
+#include <QObject>
+#include <QVector>
+#include <memory>
+
+#include "rsitimer.h"
+
+class QIODevice;
+class QTextStream;
+class RSIClockFake;
+class RSIIdleTimeFake;
+
+/**
+ * @class RSISimulator
+ * Runs RSITimer against a virtual clock and a trace of idle notifications
+ * and user actions, and writes what happened as a timeline. The timer is the
+ * one used in production, created through its test constructor, so the
+ * simulation goes through the same state machine.
+ */
+class RSISimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class TraceAction {
+        Idle, // the idle backend reported the user idle
+        Active, // the idle backend reported the user back
+        Skip, // the user pressed skip on a break
+        Postpone, // the user pressed postpone on a break
+        Lock // the user locked the screen
+    };
+
+    struct TraceEvent {
+        qint64 second;
+        TraceAction action;
+        int idleMsec = 1000; // the timeout reached, for Idle
+    };
+
+    /**
+      @param intervals The break intervals to simulate, indexed by RSIInterval.
+      @param out Where the timeline is written to.
+    */
+    RSISimulator(const QVector<int> &intervals, const bool usePopup, const bool useIdleTimers, QTextStream &out);
+    ~RSISimulator() override;
+
+    /**
+      Reads a trace with one "<second> <action>" line per event, where the
+      action is one of idle, active, skip, postpone and lock. Lines starting
+      with # are comments. Seconds count from the start of the simulation.
+      @returns false and sets @p error if the trace is malformed.
+    */
+    static bool readTrace(QIODevice *device, QVector<TraceEvent> &events, QString *error);
+
+    /**
+      Reads idle notifications captured by RSIIdleTraceWriter, with seconds
+      counting from the start of the capture. Every idleTimeoutReached() is
+      replayed with its own timeout, so unlike with text traces the timer
+      sees the threshold timeouts as well.
+      @returns false and sets @p error if the trace is malformed.
+    */
+    static bool readIdleTrace(QIODevice *device, QVector<TraceEvent> &events, QString *error);
+
+    /**
+      Generates @p days days of office hours: bursts of work with short
+      pauses and a lunch break on weekdays, idle at night and on weekends.
+    */
+    static QVector<TraceEvent> officeTrace(const int days, const quint32 seed);
+
+    /**
+      Simulates @p trace, and the time after its last event up to
+      @p duration seconds.
+    */
+    void run(const QVector<TraceEvent> &trace, const qint64 duration);
+
+    // @returns how many times each kind of timeline entry was written.
+    const QMap<QString, int> &counts() const
+    {
+        return m_counts;
+    }
+
+private:
+    RSIIdleTimeFake *m_idleTime;
+    RSIClockFake *m_clock;
+    std::unique_ptr<RSITimer> m_timer;
+    QTextStream &m_out;
+
+    qint64 m_now = 0; // seconds since the start
+    RSITimer::TimerState m_lastState;
+    QVector<bool> m_wasReset; // by index in the timer's break tiers
+    QMap<QString, int> m_counts;
+
+    // Moves the clock to @p second, stopping at every possible transition.
+    void advanceTo(const qint64 second);
+
+    // @returns the ticks to the next tick which may change the timer state.
+    qint64 ticksToNextTransition() const;
+
+    void apply(const TraceEvent &event);
+
+    // Reports state changes and idle resets since the last call.
+    void checkTransitions();
+
+    // @returns the tier name of the break in progress or just suggested.
+    QString breakKind() const;
+
+    // @returns "tiny", "big", or "tier<n>" for the extra tiers.
+    static QString tierName(const int tier);
+
+    void report(const QString &event, const QString &detail = QString());
+};
+
+#endif // RSIBREAK_RSISIMULATOR_H
@@ -5,301 +5,492 @@
 */
 
 #include "rsistats.h"
-#include "rsistatitem.h"
+#include "rsiactivitylog.h"
+#include "rsihistory.h"
+#include "rsistatsmodel.h"
 
 #include <QDateTime>
 #include <QLocale>
+#include <QtAlgorithms>
 
-#include <KLocalizedString>
-
-RSIStats::RSIStats()
-    : m_doUpdates(false)
-{
-    m_statistics.insert(TOTAL_TIME, new RSIStatItem(i18n("Total recorded time")));
-    m_statistics[TOTAL_TIME]->addDerivedItem(ACTIVITY_PERC);
-
-    m_statistics.insert(ACTIVITY, new RSIStatItem(i18n("Total time of activity")));
-    m_statistics[ACTIVITY]->addDerivedItem(ACTIVITY_PERC);
-    m_statistics[ACTIVITY]->addDerivedItem(ACTIVITY_PERC_MINUTE);
-    m_statistics[ACTIVITY]->addDerivedItem(ACTIVITY_PERC_HOUR);
-    m_statistics[ACTIVITY]->addDerivedItem(ACTIVITY_PERC_6HOUR);
-
-    m_statistics.insert(IDLENESS, new RSIStatItem(i18n("Total time being idle")));
-    m_statistics[IDLENESS]->addDerivedItem(ACTIVITY_PERC_MINUTE);
-    m_statistics[IDLENESS]->addDerivedItem(ACTIVITY_PERC_HOUR);
-    m_statistics[IDLENESS]->addDerivedItem(ACTIVITY_PERC_6HOUR);
-
-    m_statistics.insert(ACTIVITY_PERC, new RSIStatItem(i18n("Percentage of activity"), 0));
-
-    m_statistics.insert(ACTIVITY_PERC_MINUTE, new RSIStatBitArrayItem(i18n("Percentage of activity last minute"), QVariant(0), 60));
-    m_statistics.insert(ACTIVITY_PERC_HOUR, new RSIStatBitArrayItem(i18n("Percentage of activity last hour"), QVariant(0), 3600));
-    m_statistics.insert(ACTIVITY_PERC_6HOUR, new RSIStatBitArrayItem(i18n("Percentage of activity last 6 hours"), QVariant(0), 6 * 3600));
-
-    m_statistics.insert(MAX_IDLENESS, new RSIStatItem(i18n("Maximum idle period")));
-    m_statistics[MAX_IDLENESS]->addDerivedItem(IDLENESS);
+#include <algorithm>
+#include <limits>
 
-    m_statistics.insert(CURRENT_IDLE_TIME, new RSIStatItem(i18n("Current idle period")));
-
-    m_statistics.insert(IDLENESS_CAUSED_SKIP_TINY, new RSIStatItem(i18n("Number of skipped short breaks (idle)")));
-
-    m_statistics.insert(IDLENESS_CAUSED_SKIP_BIG, new RSIStatItem(i18n("Number of skipped long breaks (idle)")));
-
-    m_statistics.insert(TINY_BREAKS, new RSIStatItem(i18n("Total number of short breaks")));
-    m_statistics[TINY_BREAKS]->addDerivedItem(PAUSE_SCORE);
-    m_statistics[TINY_BREAKS]->addDerivedItem(LAST_TINY_BREAK);
-
-    m_statistics.insert(TINY_BREAKS_SKIPPED, new RSIStatItem(i18n("Number of skipped short breaks (user)")));
-    m_statistics[TINY_BREAKS_SKIPPED]->addDerivedItem(PAUSE_SCORE);
-
-    m_statistics.insert(TINY_BREAKS_POSTPONED, new RSIStatItem(i18n("Number of postponed short breaks (user)")));
-
-    QDateTime dt(QDate(-1, -1, -1), QTime(-1, -1, -1));
-    m_statistics.insert(LAST_TINY_BREAK, new RSIStatItem(i18n("Last short break"), dt));
+#include <KLocalizedString>
 
-    m_statistics.insert(BIG_BREAKS, new RSIStatItem(i18n("Total number of long breaks")));
-    m_statistics[BIG_BREAKS]->addDerivedItem(PAUSE_SCORE);
-    m_statistics[BIG_BREAKS]->addDerivedItem(LAST_BIG_BREAK);
+// Timestamp of a statistic which has not happened yet.
+static constexpr qint64 NEVER = std::numeric_limits<qint64>::min();
 
-    m_statistics.insert(BIG_BREAKS_SKIPPED, new RSIStatItem(i18n("Number of skipped long breaks (user)")));
-    m_statistics[BIG_BREAKS_SKIPPED]->addDerivedItem(PAUSE_SCORE);
+namespace
+{
+enum StatKind {
+    Counter, // seconds or a number of breaks, in m_counters
+    Ratio, // percentages, in m_ratios
+    Timestamp // in m_timestamps
+};
+
+// How a derived statistic follows the statistics it is derived from.
+enum DerivedRule {
+    NotDerived,
+    Computed, // worked out from its sources when read
+    ActivityWindow, // the activity over a period, read from the activity history
+    Accumulated, // a second more on every write to its source
+    Stamped // the current time on every write to its source
+};
+
+struct Dependency {
+    RSIStat source;
+    RSIStat derived;
+};
+}
 
-    m_statistics.insert(BIG_BREAKS_POSTPONED, new RSIStatItem(i18n("Number of postponed long breaks (user)")));
+// The kind of value of every statistic, by RSIStat.
+static constexpr StatKind statKinds[STAT_COUNT] = {
+    Counter, // TOTAL_TIME
+    Counter, // ACTIVITY
+    Counter, // IDLENESS
+    Ratio, // ACTIVITY_PERC
+    Ratio, // ACTIVITY_PERC_MINUTE
+    Ratio, // ACTIVITY_PERC_HOUR
+    Ratio, // ACTIVITY_PERC_6HOUR
+    Counter, // MAX_IDLENESS
+    Counter, // CURRENT_IDLE_TIME
+    Counter, // IDLENESS_CAUSED_SKIP_TINY
+    Counter, // IDLENESS_CAUSED_SKIP_BIG
+    Counter, // TINY_BREAKS
+    Counter, // TINY_BREAKS_SKIPPED
+    Counter, // TINY_BREAKS_POSTPONED
+    Timestamp, // LAST_TINY_BREAK
+    Counter, // BIG_BREAKS
+    Counter, // BIG_BREAKS_SKIPPED
+    Counter, // BIG_BREAKS_POSTPONED
+    Timestamp, // LAST_BIG_BREAK
+    Ratio, // PAUSE_SCORE
+};
+
+// The key of every statistic in toVariantMap(), by RSIStat.
+static constexpr const char *statKeys[STAT_COUNT] = {
+    "totalTime",
+    "activity",
+    "idleness",
+    "activityPercentage",
+    "activityPercentageMinute",
+    "activityPercentageHour",
+    "activityPercentage6Hours",
+    "maxIdleness",
+    "currentIdleTime",
+    "idlenessCausedSkipTiny",
+    "idlenessCausedSkipBig",
+    "tinyBreaks",
+    "tinyBreaksSkipped",
+    "tinyBreaksPostponed",
+    "lastTinyBreak",
+    "bigBreaks",
+    "bigBreaksSkipped",
+    "bigBreaksPostponed",
+    "lastBigBreak",
+    "pauseScore",
+};
+
+// The rule of every statistic, by RSIStat.
+static constexpr DerivedRule derivedRules[STAT_COUNT] = {
+    NotDerived, // TOTAL_TIME
+    NotDerived, // ACTIVITY
+    Accumulated, // IDLENESS
+    Computed, // ACTIVITY_PERC
+    ActivityWindow, // ACTIVITY_PERC_MINUTE
+    ActivityWindow, // ACTIVITY_PERC_HOUR
+    ActivityWindow, // ACTIVITY_PERC_6HOUR
+    NotDerived, // MAX_IDLENESS
+    NotDerived, // CURRENT_IDLE_TIME
+    NotDerived, // IDLENESS_CAUSED_SKIP_TINY
+    NotDerived, // IDLENESS_CAUSED_SKIP_BIG
+    NotDerived, // TINY_BREAKS
+    NotDerived, // TINY_BREAKS_SKIPPED
+    NotDerived, // TINY_BREAKS_POSTPONED
+    Stamped, // LAST_TINY_BREAK
+    NotDerived, // BIG_BREAKS
+    NotDerived, // BIG_BREAKS_SKIPPED
+    NotDerived, // BIG_BREAKS_POSTPONED
+    Stamped, // LAST_BIG_BREAK
+    Computed, // PAUSE_SCORE
+};
+
+static constexpr Dependency dependencies[] = {
+    {TOTAL_TIME, ACTIVITY_PERC},
+    {ACTIVITY, ACTIVITY_PERC},
+    {ACTIVITY, ACTIVITY_PERC_MINUTE},
+    {ACTIVITY, ACTIVITY_PERC_HOUR},
+    {ACTIVITY, ACTIVITY_PERC_6HOUR},
+    {IDLENESS, ACTIVITY_PERC_MINUTE},
+    {IDLENESS, ACTIVITY_PERC_HOUR},
+    {IDLENESS, ACTIVITY_PERC_6HOUR},
+    {MAX_IDLENESS, IDLENESS},
+    {TINY_BREAKS, PAUSE_SCORE},
+    {TINY_BREAKS, LAST_TINY_BREAK},
+    {TINY_BREAKS_SKIPPED, PAUSE_SCORE},
+    {IDLENESS_CAUSED_SKIP_TINY, PAUSE_SCORE},
+    {BIG_BREAKS, PAUSE_SCORE},
+    {BIG_BREAKS, LAST_BIG_BREAK},
+    {BIG_BREAKS_SKIPPED, PAUSE_SCORE},
+    {IDLENESS_CAUSED_SKIP_BIG, PAUSE_SCORE},
+};
+
+// The period of every ActivityWindow statistic, from ACTIVITY_PERC_MINUTE on.
+static constexpr int activityWindowSeconds[] = {
+    RSIActivityHistory::MINUTE, // ACTIVITY_PERC_MINUTE
+    RSIActivityHistory::HOUR, // ACTIVITY_PERC_HOUR
+    6 * RSIActivityHistory::HOUR, // ACTIVITY_PERC_6HOUR
+};
+
+static_assert(STAT_COUNT <= 32, "statistics are kept in 32 bit masks");
+
+static constexpr quint32 statBit(const int stat)
+{
+    return 1u << stat;
+}
 
-    m_statistics.insert(LAST_BIG_BREAK, new RSIStatItem(i18n("Last long break"), dt));
+// The statistics written to the activity log as break events.
+static constexpr quint32 loggedEvents = statBit(TINY_BREAKS) | statBit(TINY_BREAKS_SKIPPED) | statBit(TINY_BREAKS_POSTPONED) | statBit(IDLENESS_CAUSED_SKIP_TINY)
+    | statBit(BIG_BREAKS) | statBit(BIG_BREAKS_SKIPPED) | statBit(BIG_BREAKS_POSTPONED) | statBit(IDLENESS_CAUSED_SKIP_BIG);
 
-    m_statistics.insert(PAUSE_SCORE, new RSIStatItem(i18n("Pause score"), 100));
+// The statistics derived from each statistic, as a mask by RSIStat.
+static constexpr std::array<quint32, STAT_COUNT> derivedMasks()
+{
+    std::array<quint32, STAT_COUNT> masks{};
+    for (const Dependency &dependency : dependencies) {
+        masks[dependency.source] |= statBit(dependency.derived);
+    }
+    return masks;
+}
+static constexpr std::array<quint32, STAT_COUNT> derivedOf = derivedMasks();
 
-    // initialise labels
-    for (int i = 0; i < STAT_COUNT; ++i) {
-        QLabel *l = new QLabel(nullptr);
-        const QString whatsThis = getWhatsThisText(static_cast<RSIStat>(i));
-        l->setWhatsThis(whatsThis);
-        m_statistics[i]->getDescription()->setWhatsThis(whatsThis);
-        m_labels << l;
+// Statistics are only derived from recorded ones, or from accumulated ones
+// which are all that is derived from their source. updateDependentStats()
+// relies on that to do without recursion.
+static constexpr bool chainsAreShort()
+{
+    for (const Dependency &dependency : dependencies) {
+        if (derivedRules[dependency.source] != NotDerived && derivedRules[dependency.source] != Accumulated) {
+            return false;
+        }
+        if (derivedRules[dependency.derived] == NotDerived) {
+            return false;
+        }
+        // The accumulated statistic takes over the walk from its source.
+        if (derivedRules[dependency.derived] == Accumulated && derivedOf[dependency.source] != statBit(dependency.derived)) {
+            return false;
+        }
     }
+    return true;
+}
+static_assert(chainsAreShort(), "derived statistics only follow recorded or accumulated ones");
 
+RSIStats::RSIStats()
+    : m_doUpdates(false)
+{
     // initialise statistics
     reset();
 }
 
 RSIStats::~RSIStats()
 {
-    qDeleteAll(m_labels);
-
-    for (int i = 0; i < STAT_COUNT; ++i) {
-        RSIStatItem *item = m_statistics[i];
-        QLabel *l = item->getDescription();
-        delete l;
-        delete item;
+    if (m_model) {
+        m_model->statsDestroyed();
     }
 }
 
 void RSIStats::reset()
 {
+    m_counters.fill(0);
+    m_ratios.fill(0.0);
+    m_ratios[PAUSE_SCORE] = 100.0;
+    m_timestamps.fill(NEVER);
+    m_dirty = 0;
+    m_activity.reset();
+
     for (int i = 0; i < STAT_COUNT; ++i) {
-        m_statistics[i]->reset();
         updateStat(static_cast<RSIStat>(i), /* update derived stats */ false);
     }
 }
 
-void RSIStats::increaseStat(RSIStat stat, int delta)
+void RSIStats::increaseStat(RSIStat stat, int delta, qint64 end)
 {
-    QVariant v = m_statistics[stat]->getValue();
+    Q_ASSERT(statKinds[stat] == Counter);
+    m_counters[stat] += delta;
 
-    if (v.userType() == QMetaType::Int)
-        m_statistics[stat]->setValue(v.toInt() + delta);
-    else if (v.userType() == QMetaType::Double)
-        m_statistics[stat]->setValue(v.toDouble() + (double)delta);
-    else if (v.userType() == QMetaType::QDateTime)
-        m_statistics[stat]->setValue(QDateTime(v.toDateTime()).addSecs(delta));
+    if (m_log && (loggedEvents & statBit(stat))) {
+        const qint64 time = end ? end : QDateTime::currentSecsSinceEpoch();
+        for (int i = 0; i < delta; ++i) {
+            m_log->recordEvent(stat, time);
+        }
+    }
 
-    updateStat(stat);
+    updateStat(stat, true, delta, end);
 }
 
-void RSIStats::setStat(RSIStat stat, const QVariant &val, bool ifmax)
+void RSIStats::setCounter(RSIStat stat, qint64 value, bool ifmax, qint64 end)
 {
-    QVariant v = m_statistics[stat]->getValue();
-
-    if (!ifmax || (v.userType() == QMetaType::Int && val.toInt() > v.toInt()) || (v.userType() == QMetaType::Double && val.toDouble() > v.toDouble())
-        || (v.userType() == QMetaType::QDateTime && val.toDateTime() > v.toDateTime()))
-        m_statistics[stat]->setValue(val);
+    Q_ASSERT(statKinds[stat] == Counter);
+    m_counters[stat] = ifmax ? std::max(m_counters[stat], value) : value;
 
     // WATCH OUT: IDLENESS is derived from MAX_IDLENESS and needs to be
     // updated regardless if a new value is set.
-    updateStat(stat);
+    updateStat(stat, true, 1, end);
 }
 
-void RSIStats::updateDependentStats(RSIStat stat)
+void RSIStats::setTimestamp(RSIStat stat, const QDateTime &when)
 {
-    const QList<RSIStat> &stats = m_statistics[stat]->getDerivedItems();
-    for (int i = 0; i < stats.count(); ++i) {
-        RSIStat it = stats.at(i);
-        switch ((it)) {
-        case PAUSE_SCORE: {
-            double a = m_statistics[TINY_BREAKS_SKIPPED]->getValue().toDouble();
-            double b = m_statistics[BIG_BREAKS_SKIPPED]->getValue().toDouble();
-            double c = m_statistics[IDLENESS_CAUSED_SKIP_TINY]->getValue().toDouble();
-            double d = m_statistics[IDLENESS_CAUSED_SKIP_BIG]->getValue().toDouble();
-
-            RSIGlobals *glbl = RSIGlobals::instance();
-            double ratio = (double)(glbl->intervals()[BIG_BREAK_DURATION]) / (double)(glbl->intervals()[TINY_BREAK_DURATION]);
-
-            double skipped = a - c + ratio * (b - d);
-            skipped = skipped < 0 ? 0 : skipped;
-
-            double total = m_statistics[TINY_BREAKS]->getValue().toDouble();
-            total += ratio * m_statistics[BIG_BREAKS]->getValue().toDouble();
-
-            if (total > 0)
-                m_statistics[it]->setValue(100 - ((skipped / total) * 100));
-            else
-                m_statistics[it]->setValue(0);
-
-            updateStat(it);
-            break;
-        }
+    Q_ASSERT(statKinds[stat] == Timestamp);
+    m_timestamps[stat] = when.isValid() ? when.toMSecsSinceEpoch() : NEVER;
 
-        case IDLENESS: {
-            increaseStat(IDLENESS);
-            break;
-        }
+    updateStat(stat);
+}
 
-        case ACTIVITY_PERC: {
-            /*
-                                            seconds of activity
-                activity_percentage =  100 - -------------------
-                                                total seconds
-            */
+double RSIStats::ratio(RSIStat stat) const
+{
+    refresh(stat);
+    return m_ratios[stat];
+}
 
-            double activity = m_statistics[ACTIVITY]->getValue().toDouble();
-            double total = m_statistics[TOTAL_TIME]->getValue().toDouble();
+QDateTime RSIStats::timestamp(RSIStat stat) const
+{
+    return m_timestamps[stat] == NEVER ? QDateTime() : QDateTime::fromMSecsSinceEpoch(m_timestamps[stat]);
+}
 
-            if (total > 0)
-                m_statistics[it]->setValue((activity / total) * 100);
-            else
-                m_statistics[it]->setValue(0);
+void RSIStats::setActivityLog(RSIActivityLog *log)
+{
+    m_log = log;
+    m_history.reset(m_log ? new RSIHistory(m_log) : nullptr);
+    if (!m_log) {
+        return;
+    }
 
-            updateStat(it);
-            break;
+    m_log->replay(m_activity, QDateTime::currentSecsSinceEpoch());
+    for (int i = 0; i < STAT_COUNT; ++i) {
+        if (derivedRules[i] == ActivityWindow) {
+            m_dirty |= statBit(i);
+            updateStat(static_cast<RSIStat>(i), /* update derived stats */ false);
         }
+    }
+}
+
+void RSIStats::setStat(RSIStat stat, const QVariant &val, bool ifmax)
+{
+    switch (statKinds[stat]) {
+    case Counter:
+        setCounter(stat, val.toLongLong(), ifmax);
+        break;
+    case Ratio:
+        if (!ifmax || val.toDouble() > ratio(stat)) {
+            m_ratios[stat] = val.toDouble();
+            m_dirty &= ~statBit(stat);
+        }
+        updateStat(stat);
+        break;
+    case Timestamp:
+        if (!ifmax || val.toDateTime() > timestamp(stat)) {
+            setTimestamp(stat, val.toDateTime());
+        } else {
+            updateStat(stat);
+        }
+        break;
+    }
+}
 
-        case ACTIVITY_PERC_MINUTE:
-        case ACTIVITY_PERC_HOUR:
-        case ACTIVITY_PERC_6HOUR: {
-            if (stat == ACTIVITY)
-                static_cast<RSIStatBitArrayItem *>(m_statistics[it])->setActivity();
-            else
-                static_cast<RSIStatBitArrayItem *>(m_statistics[it])->setIdle();
+quint32 RSIStats::updateDependentStats(RSIStat stat, int delta, qint64 end)
+{
+    quint32 changed = 0;
+    bool recorded = false;
+    quint32 derived = derivedOf[stat];
+    while (derived) {
+        const RSIStat it = static_cast<RSIStat>(qCountTrailingZeroBits(derived));
+        derived &= derived - 1;
+        changed |= statBit(it);
+
+        switch (derivedRules[it]) {
+        case Computed:
+            m_dirty |= statBit(it);
+            break;
 
-            updateStat(it);
+        case ActivityWindow:
+            // All windows share the history, the seconds go in once.
+            if (!recorded) {
+                m_activity.record(stat == ACTIVITY, delta);
+                if (m_log)
+                    m_log->record(stat == ACTIVITY, delta, end ? end : QDateTime::currentSecsSinceEpoch());
+                recorded = true;
+            }
+            m_dirty |= statBit(it);
             break;
-        }
 
-        case LAST_BIG_BREAK: {
-            setStat(LAST_BIG_BREAK, QDateTime::currentDateTime());
+        case Accumulated:
+            // Setting MAX_IDLENESS accounts one second of IDLENESS, and so
+            // for the statistics derived from IDLENESS as well.
+            m_counters[it] += 1;
+            stat = it;
+            delta = 1;
+            derived |= derivedOf[it];
             break;
-        }
 
-        case LAST_TINY_BREAK: {
-            setStat(LAST_TINY_BREAK, QDateTime::currentDateTime());
+        case Stamped:
+            m_timestamps[it] = QDateTime::currentMSecsSinceEpoch();
             break;
-        }
 
-        default:; // nada
+        case NotDerived:
+            break;
         }
     }
+    return changed;
 }
 
-void RSIStats::updateStat(RSIStat stat, bool updateDerived)
+void RSIStats::refresh(RSIStat stat) const
 {
-    if (updateDerived)
-        updateDependentStats(stat);
+    if (!(m_dirty & statBit(stat))) {
+        return;
+    }
+    m_dirty &= ~statBit(stat);
 
-    if (m_doUpdates)
-        updateLabel(stat);
-}
+    switch (stat) {
+    case PAUSE_SCORE: {
+        double a = m_counters[TINY_BREAKS_SKIPPED];
+        double b = m_counters[BIG_BREAKS_SKIPPED];
+        double c = m_counters[IDLENESS_CAUSED_SKIP_TINY];
+        double d = m_counters[IDLENESS_CAUSED_SKIP_BIG];
 
-void RSIStats::updateLabel(RSIStat stat)
-{
-    QLabel *l = m_labels[stat];
-    double v;
+        RSIGlobals *glbl = RSIGlobals::instance();
+        double ratio = (double)(glbl->intervals()[BIG_BREAK_DURATION]) / (double)(glbl->intervals()[TINY_BREAK_DURATION]);
 
-    switch (stat) {
-        // integer values representing a time
-    case TOTAL_TIME:
-    case ACTIVITY:
-    case IDLENESS:
-    case MAX_IDLENESS:
-    case CURRENT_IDLE_TIME:
-        l->setText(RSIGlobals::instance()->formatSeconds(m_statistics[stat]->getValue().toInt()));
-        break;
+        double skipped = a - c + ratio * (b - d);
+        skipped = skipped < 0 ? 0 : skipped;
 
-        // plain integer values
-    case TINY_BREAKS:
-    case TINY_BREAKS_SKIPPED:
-    case TINY_BREAKS_POSTPONED:
-    case IDLENESS_CAUSED_SKIP_TINY:
-    case BIG_BREAKS:
-    case BIG_BREAKS_SKIPPED:
-    case BIG_BREAKS_POSTPONED:
-    case IDLENESS_CAUSED_SKIP_BIG:
-        l->setText(QString::number(m_statistics[stat]->getValue().toInt()));
+        double total = m_counters[TINY_BREAKS];
+        total += ratio * m_counters[BIG_BREAKS];
+
+        m_ratios[stat] = total > 0 ? 100 - ((skipped / total) * 100) : 0;
         break;
+    }
 
-        // doubles
-    case PAUSE_SCORE:
-        v = m_statistics[stat]->getValue().toDouble();
-        setColor(stat, QColor((int)(255 - 2.55 * v), (int)(1.60 * v), 0));
-        l->setText(QString::number(m_statistics[stat]->getValue().toDouble(), 'f', 1));
+    case ACTIVITY_PERC: {
+        /*
+                                        seconds of activity
+            activity_percentage =  100 - -------------------
+                                            total seconds
+        */
+
+        double activity = m_counters[ACTIVITY];
+        double total = m_counters[TOTAL_TIME];
+
+        m_ratios[stat] = total > 0 ? (activity / total) * 100 : 0;
         break;
-    case ACTIVITY_PERC:
+    }
+
     case ACTIVITY_PERC_MINUTE:
     case ACTIVITY_PERC_HOUR:
     case ACTIVITY_PERC_6HOUR:
-        v = m_statistics[stat]->getValue().toDouble();
-        setColor(stat, QColor((int)(2.55 * v), (int)(160 - 1.60 * v), 0));
-        l->setText(QString::number(m_statistics[stat]->getValue().toDouble(), 'f', 1));
+        m_ratios[stat] = 100.0 * m_activity.activeFraction(activityWindowSeconds[stat - ACTIVITY_PERC_MINUTE]);
         break;
 
-        // datetimes
-    case LAST_BIG_BREAK:
-    case LAST_TINY_BREAK: {
-        QTime when(m_statistics[stat]->getValue().toTime());
-        when.isValid() ? l->setText(when.toString()) : l->clear();
-        break;
-    }
-
     default:; // nada
     }
-
-    // some stats need a %
-    if (stat == PAUSE_SCORE || stat == ACTIVITY_PERC || stat == ACTIVITY_PERC_MINUTE || stat == ACTIVITY_PERC_HOUR || stat == ACTIVITY_PERC_6HOUR)
-        l->setText(l->text() + '%');
 }
 
-void RSIStats::updateLabels()
+void RSIStats::updateStat(RSIStat stat, bool updateDerived, int delta, qint64 end)
 {
-    if (!m_doUpdates)
-        return;
+    quint32 changed = statBit(stat);
+    if (updateDerived)
+        changed |= updateDependentStats(stat, delta, end);
 
-    for (int i = 0; i < STAT_COUNT; ++i) {
-        updateLabel(static_cast<RSIStat>(i));
+    if (m_doUpdates && m_model) {
+        m_model->statsChanged(changed);
     }
 }
 
 QVariant RSIStats::getStat(RSIStat stat) const
 {
-    return m_statistics[stat]->getValue();
+    switch (statKinds[stat]) {
+    case Counter:
+        return QVariant((int)m_counters[stat]);
+    case Ratio:
+        return QVariant(ratio(stat));
+    case Timestamp:
+        return QVariant(timestamp(stat));
+    }
+    return QVariant();
 }
 
-QLabel *RSIStats::getLabel(RSIStat stat) const
+QString RSIStats::key(RSIStat stat)
 {
-    return m_labels[stat];
+    return QString::fromLatin1(statKeys[stat]);
 }
 
-QLabel *RSIStats::getDescription(RSIStat stat) const
+QVariantMap RSIStats::toVariantMap() const
 {
-    return m_statistics[stat]->getDescription();
+    QVariantMap map;
+    for (int i = 0; i < STAT_COUNT; ++i) {
+        const RSIStat stat = static_cast<RSIStat>(i);
+        switch (statKinds[stat]) {
+        case Counter:
+            map.insert(key(stat), qlonglong(m_counters[stat]));
+            break;
+        case Ratio:
+            map.insert(key(stat), ratio(stat));
+            break;
+        case Timestamp:
+            map.insert(key(stat), timestamp(stat).toString(Qt::ISODate));
+            break;
+        }
+    }
+    return map;
+}
+
+QString RSIStats::getDescriptionText(RSIStat stat) const
+{
+    switch (stat) {
+    case TOTAL_TIME:
+        return i18n("Total recorded time");
+    case ACTIVITY:
+        return i18n("Total time of activity");
+    case IDLENESS:
+        return i18n("Total time being idle");
+    case ACTIVITY_PERC:
+        return i18n("Percentage of activity");
+    case ACTIVITY_PERC_MINUTE:
+        return i18n("Percentage of activity last minute");
+    case ACTIVITY_PERC_HOUR:
+        return i18n("Percentage of activity last hour");
+    case ACTIVITY_PERC_6HOUR:
+        return i18n("Percentage of activity last 6 hours");
+    case MAX_IDLENESS:
+        return i18n("Maximum idle period");
+    case CURRENT_IDLE_TIME:
+        return i18n("Current idle period");
+    case IDLENESS_CAUSED_SKIP_TINY:
+        return i18n("Number of skipped short breaks (idle)");
+    case IDLENESS_CAUSED_SKIP_BIG:
+        return i18n("Number of skipped long breaks (idle)");
+    case TINY_BREAKS:
+        return i18n("Total number of short breaks");
+    case TINY_BREAKS_SKIPPED:
+        return i18n("Number of skipped short breaks (user)");
+    case TINY_BREAKS_POSTPONED:
+        return i18n("Number of postponed short breaks (user)");
+    case LAST_TINY_BREAK:
+        return i18n("Last short break");
+    case BIG_BREAKS:
+        return i18n("Total number of long breaks");
+    case BIG_BREAKS_SKIPPED:
+        return i18n("Number of skipped long breaks (user)");
+    case BIG_BREAKS_POSTPONED:
+        return i18n("Number of postponed long breaks (user)");
+    case LAST_BIG_BREAK:
+        return i18n("Last long break");
+    case PAUSE_SCORE:
+        return i18n("Pause score");
+    default:;
+    }
+
+    return QString();
 }
 
 QString RSIStats::getWhatsThisText(RSIStat stat) const
@@ -390,17 +581,7 @@ QString RSIStats::getWhatsThisText(RSIStat stat) const
     return QString();
 }
 
-void RSIStats::setColor(RSIStat stat, const QColor &color)
-{
-    QPalette normal;
-    normal.setColor(QPalette::Active, QPalette::WindowText, color);
-    m_statistics[stat]->getDescription()->setPalette(normal);
-    m_labels[stat]->setPalette(normal);
-}
-
 void RSIStats::doUpdates(bool b)
 {
     m_doUpdates = b;
-    if (m_doUpdates)
-        updateLabels();
 }
@@ -8,22 +8,30 @@
 #ifndef RSISTATS_H
 #define RSISTATS_H
 
-#include "rsiglobals.h"
+#include <QDateTime>
+#include <QVariant>
+#include <array>
+#include <memory>
 
-class QLabel;
+#include "rsiactivityhistory.h"
+#include "rsiglobals.h"
 
-class RSIStatItem;
+class RSIActivityLog;
+class RSIHistory;
+class RSIStatsModel;
 
 /**
-  This class records all statistics, gathered by the RSITimer.
+  This class records all statistics, gathered by the RSITimer. It holds no
+  widgets, RSIStatsModel presents the statistics to views.
   To add a stat, you should add an alias to the RSIStat enum, found
-  in RSIGlobal. Then, add the statistic to the constructor of this class
-  and to the updateLabel method. Don't forget to add a What's This text as well
-  in the getWhatsThisText() method.
+  in RSIGlobal. Then, add its kind of value to the statKinds table, its
+  key to statKeys, the statistic to the getDescriptionText() method and
+  RSIStatsModel::valueText(). Don't forget to add a What's This text as
+  well in the getWhatsThisText() method.
   If you add a statistic which is calculated from other statistics, don't
-  forget to add those statistics as a dependency in the constructor of this
-  class. The value of the derived statistic will be calculated in
-  updateDependentStats().
+  forget to give it a rule in derivedRules and add those statistics to the
+  dependencies table. Computed statistics are only marked dirty on writes,
+  and worked out in refresh() when they are read.
   The last step involves to actually put it in the statistics widget. Use
   the addStat() method there.
 
@@ -42,11 +50,58 @@ public:
     /** Sets all statistics to it's initial value. */
     void reset();
 
-    /** Increase the value of statistic @p stat with @p delta (default: 1). */
-    void increaseStat(RSIStat stat, int delta = 1);
+    /**
+     * Increase the value of counter statistic @p stat with @p delta (default: 1).
+     * @param end Seconds since the epoch at the end of the @p delta seconds,
+     * for the activity log. 0 means now.
+     */
+    void increaseStat(RSIStat stat, int delta = 1, qint64 end = 0);
 
     /**
-     * Sets the value of a statistic.
+     * Sets the value of a counter statistic.
+     * @param ifmax If true, the value will only be assigned if the current
+     * value is lower. Derived stats are updated regardless.
+     * @param end As for increaseStat().
+     */
+    void setCounter(RSIStat stat, qint64 value, bool ifmax = false, qint64 end = 0);
+
+    /** Sets timestamp statistic @p stat to @p when. */
+    void setTimestamp(RSIStat stat, const QDateTime &when);
+
+    /** Returns the value of counter statistic @p stat. */
+    qint64 counter(RSIStat stat) const
+    {
+        return m_counters[stat];
+    }
+
+    /** Returns the value of percentage statistic @p stat. */
+    double ratio(RSIStat stat) const;
+
+    /** Returns timestamp statistic @p stat, invalid if it never happened. */
+    QDateTime timestamp(RSIStat stat) const;
+
+    /**
+     * Also writes the seconds of activity and the break events to @p log,
+     * and reloads the activity of the last week from it. Set it to nullptr
+     * to stop logging.
+     */
+    void setActivityLog(RSIActivityLog *log);
+
+    /** @returns the history of the activity log, nullptr without a log. */
+    RSIHistory *history() const
+    {
+        return m_history.get();
+    }
+
+    /** @returns the seconds of activity and idleness of the last week. */
+    const RSIActivityHistory &activity() const
+    {
+        return m_activity;
+    }
+
+    /**
+     * Sets the value of a statistic, of any kind. Kept for the user
+     * interface, the typed setters above do not go through QVariant.
      * @param stat The statistic in question.
      * @param val The value to be assigned to the statistic. In QVariant format.
      * @param ifmax If true, the value will only be assigned if the current
@@ -55,67 +110,94 @@ public:
      */
     void setStat(RSIStat stat, const QVariant &val, bool ifmax = false);
 
+    /** Gets the value given the @p stat, of any kind.*/
+    QVariant getStat(RSIStat stat) const;
+
+    /** @returns the name of @p stat in the map of toVariantMap(). */
+    static QString key(RSIStat stat);
+
     /**
-     * Set the color of a given statistic.
-     * @param stat The statistic in question.
-     * @param color The color in QColor format.
+     * @returns all statistics by key(), in types D-Bus can carry: counters
+     * as qlonglong, ratios as double and timestamps as ISO 8601 strings,
+     * empty when they did not happen yet.
      */
-    void setColor(RSIStat stat, const QColor &color);
-
-    /** Returns a description for the given @p stat. */
-    QLabel *getDescription(RSIStat stat) const;
+    QVariantMap toVariantMap() const;
 
     /**
-     * Updates all labels to the current value of their corresponding
-     * statistic.
+     * Retrieves What's This? text for a given statistic @p stat.
      */
-    void updateLabels();
+    QString getWhatsThisText(RSIStat stat) const;
 
-    /** Gets the value given the @p stat.*/
-    QVariant getStat(RSIStat stat) const;
+    /** Retrieves the description shown next to statistic @p stat. */
+    QString getDescriptionText(RSIStat stat) const;
 
-    /** Gets the value of the statistic @p stat in QLabel format. */
-    QLabel *getLabel(RSIStat stat) const;
+    /**
+     * Tells @p model which statistics changed, while updates are on. Set
+     * it to nullptr when the model goes away.
+     */
+    void setModel(RSIStatsModel *model)
+    {
+        m_model = model;
+    }
 
     /**
-      This function prevents RSIStats from calls to updateLabel when
+      This function prevents RSIStats from notifying the model when
       it's not really needed, e.g. when the widget is not visible.
-      @param b If true, it will update the labels as soon as the stats
-      update.
+      @param b If true, the model hears of every update of the stats.
     */
     void doUpdates(bool b);
 
-protected:
-    /** Update the label of given @p stat to it's corresponding value. */
-    void updateLabel(RSIStat stat);
+    /** Returns true if a view follows every update of the statistics. */
+    bool isUpdating() const
+    {
+        return m_doUpdates;
+    }
 
+protected:
     /**
      * Some statistics are calculated based on values of other statistics.
-     * This function updates all statistics with @p stat as dependency.
+     * This function updates all statistics with @p stat as dependency, or
+     * marks them dirty if they are computed.
+     * @param delta The number of seconds @p stat was increased with.
+     * @param end Seconds since the epoch the @p delta seconds end at, 0 for now.
+     * @returns the mask of statistics which changed.
      */
-    void updateDependentStats(RSIStat stat);
+    quint32 updateDependentStats(RSIStat stat, int delta = 1, qint64 end = 0);
+
+    /** Works out computed statistic @p stat if it is dirty. */
+    void refresh(RSIStat stat) const;
 
     /**
      * Updates the given statistic.
      * @param stat The statistic you've just assigned a value to.
      * @param updateDerived If true, update the derived statistics when
      * calling this function.
+     * @param delta The number of seconds @p stat was increased with, when
+     * it is recorded in the activity history.
+     * @param end Seconds since the epoch the @p delta seconds end at, 0 for now.
      */
-    void updateStat(RSIStat stat, bool updateDerived = true);
-
-    /**
-     * Retrieves What's This? text for a given statistic @p stat.
-     */
-    QString getWhatsThisText(RSIStat stat) const;
+    void updateStat(RSIStat stat, bool updateDerived = true, int delta = 1, qint64 end = 0);
 
 private:
     static RSIStats *m_instance;
 
     bool m_doUpdates;
 
-    QVector<RSIStatItem *> m_statistics;
-    /** Contains formatted labels. */
-    QVector<QLabel *> m_labels;
+    // The values by RSIStat, in the array of their kind.
+    std::array<qint64, STAT_COUNT> m_counters;
+    mutable std::array<double, STAT_COUNT> m_ratios;
+    std::array<qint64, STAT_COUNT> m_timestamps; // milliseconds since the epoch
+
+    // Seconds of activity and idleness, ACTIVITY_PERC_MINUTE and the
+    // others are read from it.
+    RSIActivityHistory m_activity;
+    RSIActivityLog *m_log = nullptr;
+    std::unique_ptr<RSIHistory> m_history;
+
+    // Computed statistics whose value is out of date, one bit per RSIStat.
+    mutable quint32 m_dirty = 0;
+
+    RSIStatsModel *m_model = nullptr;
 };
 
 #endif // RSISTATS_H
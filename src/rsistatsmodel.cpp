@@ -0,0 +1,195 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsistatsmodel.h"
+
+#include <QColor>
+#include <QTime>
+#include <QTimer>
+#include <QtAlgorithms>
+
+#include <KLocalizedString>
+
+#include "rsistats.h"
+
+RSIStatsModel::RSIStatsModel(RSIStats *stats, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_stats(stats)
+    , m_flushTimer(new QTimer(this))
+{
+    m_colors.fill(0);
+
+    // Rows are sent once the event loop is back, after all writes of a tick.
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(0);
+    connect(m_flushTimer, &QTimer::timeout, this, &RSIStatsModel::flush);
+
+    m_stats->setModel(this);
+}
+
+RSIStatsModel::~RSIStatsModel()
+{
+    // The statistics can be gone already, RSIObject deletes them first.
+    if (m_stats) {
+        m_stats->doUpdates(false);
+        m_stats->setModel(nullptr);
+    }
+}
+
+void RSIStatsModel::statsDestroyed()
+{
+    beginResetModel();
+    m_stats = nullptr;
+    m_flushTimer->stop();
+    m_changed = 0;
+    endResetModel();
+}
+
+int RSIStatsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() || !m_stats ? 0 : STAT_COUNT;
+}
+
+int RSIStatsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant RSIStatsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    const RSIStat stat = static_cast<RSIStat>(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return index.column() == DescriptionColumn ? m_stats->getDescriptionText(stat) : valueText(stat);
+    case Qt::WhatsThisRole:
+        return m_stats->getWhatsThisText(stat);
+    case Qt::ForegroundRole: {
+        const QColor c = color(stat);
+        return c.isValid() ? QVariant(c) : QVariant();
+    }
+    case Qt::TextAlignmentRole:
+        return index.column() == ValueColumn ? QVariant(Qt::AlignRight | Qt::AlignVCenter) : QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant RSIStatsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return section == DescriptionColumn ? i18n("Statistic") : i18n("Value");
+}
+
+QString RSIStatsModel::valueText(RSIStat stat) const
+{
+    switch (stat) {
+        // integer values representing a time
+    case TOTAL_TIME:
+    case ACTIVITY:
+    case IDLENESS:
+    case MAX_IDLENESS:
+    case CURRENT_IDLE_TIME:
+        return RSIGlobals::instance()->formatSeconds((int)m_stats->counter(stat));
+
+        // plain integer values
+    case TINY_BREAKS:
+    case TINY_BREAKS_SKIPPED:
+    case TINY_BREAKS_POSTPONED:
+    case IDLENESS_CAUSED_SKIP_TINY:
+    case BIG_BREAKS:
+    case BIG_BREAKS_SKIPPED:
+    case BIG_BREAKS_POSTPONED:
+    case IDLENESS_CAUSED_SKIP_BIG:
+        return QString::number(m_stats->counter(stat));
+
+        // doubles, which need a %
+    case PAUSE_SCORE:
+    case ACTIVITY_PERC:
+    case ACTIVITY_PERC_MINUTE:
+    case ACTIVITY_PERC_HOUR:
+    case ACTIVITY_PERC_6HOUR:
+        return QString::number(m_stats->ratio(stat), 'f', 1) + '%';
+
+        // datetimes
+    case LAST_BIG_BREAK:
+    case LAST_TINY_BREAK: {
+        QTime when(m_stats->timestamp(stat).time());
+        return when.isValid() ? when.toString() : QString();
+    }
+
+    default:; // nada
+    }
+    return QString();
+}
+
+QColor RSIStatsModel::color(RSIStat stat) const
+{
+    double v;
+    switch (stat) {
+    case PAUSE_SCORE:
+        v = m_stats->ratio(stat);
+        return QColor((int)(255 - 2.55 * v), (int)(1.60 * v), 0);
+    case ACTIVITY_PERC:
+    case ACTIVITY_PERC_MINUTE:
+    case ACTIVITY_PERC_HOUR:
+    case ACTIVITY_PERC_6HOUR:
+        v = m_stats->ratio(stat);
+        return QColor((int)(2.55 * v), (int)(160 - 1.60 * v), 0);
+    default:
+        return m_colors[stat] ? QColor::fromRgb(m_colors[stat]) : QColor();
+    }
+}
+
+void RSIStatsModel::setActive(bool active)
+{
+    if (!m_stats) {
+        return;
+    }
+    m_stats->doUpdates(active);
+    if (active) {
+        m_changed = (1u << STAT_COUNT) - 1;
+        flush();
+    }
+}
+
+void RSIStatsModel::setColor(RSIStat stat, const QColor &color)
+{
+    if (m_colors[stat] == color.rgb()) {
+        return;
+    }
+    m_colors[stat] = color.rgb();
+    if (m_stats && m_stats->isUpdating()) {
+        statsChanged(1u << stat);
+    }
+}
+
+void RSIStatsModel::statsChanged(quint32 changed)
+{
+    m_changed |= changed;
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void RSIStatsModel::flush()
+{
+    m_flushTimer->stop();
+
+    // One signal per run of adjacent rows.
+    quint32 changed = m_changed;
+    m_changed = 0;
+    while (changed) {
+        const int first = qCountTrailingZeroBits(changed);
+        const quint32 rest = ~(changed >> first);
+        const int count = rest ? qCountTrailingZeroBits(rest) : 32 - first;
+        emit dataChanged(index(first, DescriptionColumn), index(first + count - 1, ValueColumn));
+        changed = first + count == 32 ? 0 : changed & ~(((1u << count) - 1) << first);
+    }
+}
@@ -0,0 +1,83 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSISTATSMODEL_H
+#define RSIBREAK_RSISTATSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QRgb>
+#include <array>
+
+#include "rsiglobals.h"
+
+class QTimer;
+class RSIStats;
+
+/**
+ * @class RSIStatsModel
+ * Presents RSIStats as a table with a row per RSIStat, its description and
+ * its formatted value. Percentages and the last breaks are colored through
+ * Qt::ForegroundRole.
+ *
+ * Changes are collected while the model is active and sent once per event
+ * loop iteration, as one dataChanged() per range of adjacent rows.
+ */
+class RSIStatsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        DescriptionColumn = 0,
+        ValueColumn,
+        ColumnCount
+    };
+
+    explicit RSIStatsModel(RSIStats *stats, QObject *parent = nullptr);
+    ~RSIStatsModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * Only an active model follows the statistics. Activating it brings
+     * all rows up to date.
+     */
+    void setActive(bool active);
+
+    /** Sets the color of @p stat, like the tray does for the last breaks. */
+    void setColor(RSIStat stat, const QColor &color);
+
+    /**
+     * Called by RSIStats when it is destroyed before the model. The model
+     * is left without rows.
+     */
+    void statsDestroyed();
+
+    /** Called by RSIStats with the mask of statistics which changed. */
+    void statsChanged(quint32 changed);
+
+    /** @returns the value of @p stat, as shown. */
+    QString valueText(RSIStat stat) const;
+
+    /** @returns the color of @p stat, or an invalid one for the default. */
+    QColor color(RSIStat stat) const;
+
+private:
+    // Sends dataChanged() for the collected rows.
+    void flush();
+
+    RSIStats *m_stats;
+    QTimer *m_flushTimer;
+
+    // Rows which changed since the last flush, one bit per RSIStat.
+    quint32 m_changed = 0;
+
+    // Colors set with setColor(), 0 for none.
+    std::array<QRgb, STAT_COUNT> m_colors;
+};
+
+#endif // RSIBREAK_RSISTATSMODEL_H
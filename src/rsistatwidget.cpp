@@ -6,8 +6,12 @@
 */
 
 #include "rsistatwidget.h"
+#include "rsiactivityheatmap.h"
+#include "rsihistory.h"
 #include "rsistats.h"
+#include "rsistatsmodel.h"
 
+#include <QComboBox>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QLabel>
@@ -17,9 +21,19 @@
 #include <KLocalizedString>
 #include <QFontDatabase>
 
+#include <algorithm>
+
 RSIStatWidget::RSIStatWidget(QWidget *parent)
     : QWidget(parent)
+    , m_model(new RSIStatsModel(RSIGlobals::instance()->stats(), this))
+    , m_descriptions(STAT_COUNT, nullptr)
+    , m_values(STAT_COUNT, nullptr)
+    , m_colors(STAT_COUNT)
 {
+    connect(m_model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        updateRows(topLeft.row(), bottomRight.row());
+    });
+
     mGrid = new QGridLayout(this);
 
     QGroupBox *gb = new QGroupBox(i18n("Time"), this);
@@ -57,6 +71,53 @@ RSIStatWidget::RSIStatWidget(QWidget *parent)
     addStat(BIG_BREAKS_POSTPONED, subgrid, 3);
     addStat(IDLENESS_CAUSED_SKIP_BIG, subgrid, 4);
     mGrid->addWidget(gb, 1, 1);
+
+    gb = new QGroupBox(i18n("Activity"), this);
+    subgrid = new QGridLayout(gb);
+    QComboBox *heatmapPeriod = new QComboBox(gb);
+    heatmapPeriod->addItem(i18n("Last 24 hours"), QVariant::fromValue(RSIActivityHeatmap::Period::Day));
+    heatmapPeriod->addItem(i18n("Last 7 days"), QVariant::fromValue(RSIActivityHeatmap::Period::Week));
+    m_heatmap = new RSIActivityHeatmap(RSIGlobals::instance()->stats()->activity(), gb);
+    m_heatmap->setWhatsThis(
+        i18n("How active you were lately. Over the last 24 hours every row is an hour and every cell a minute, "
+             "over the last 7 days every row is a day and every cell a quarter of an hour. The current one is at the bottom."));
+    connect(heatmapPeriod, &QComboBox::currentIndexChanged, this, [this, heatmapPeriod]() {
+        m_heatmap->setPeriod(heatmapPeriod->currentData().value<RSIActivityHeatmap::Period>());
+    });
+    subgrid->addWidget(new QLabel(i18n("Period:"), gb), 0, 0);
+    subgrid->addWidget(heatmapPeriod, 0, 1);
+    subgrid->addWidget(m_heatmap, 1, 0, 1, 2);
+    mGrid->addWidget(gb, 2, 0, 1, 2);
+
+    m_historyBox = new QGroupBox(i18n("History"), this);
+    subgrid = new QGridLayout(m_historyBox);
+    m_historyPeriod = new QComboBox(m_historyBox);
+    m_historyPeriod->addItem(i18n("Last 7 days"), 7);
+    m_historyPeriod->addItem(i18n("Last 30 days"), 30);
+    m_historyPeriod->addItem(i18n("Last 365 days"), 365);
+    connect(m_historyPeriod, &QComboBox::currentIndexChanged, this, &RSIStatWidget::updateHistory);
+    subgrid->addWidget(new QLabel(i18n("Period:"), m_historyBox), 0, 0);
+    subgrid->addWidget(m_historyPeriod, 0, 1);
+
+    const QStringList descriptions = {i18n("Active time:"),
+                                      i18n("Breaks taken:"),
+                                      i18n("Breaks skipped:"),
+                                      i18n("Breaks postponed:"),
+                                      i18n("Longest stretch of work in a day:")};
+    QVector<QLabel *> values;
+    for (int row = 0; row < descriptions.size(); ++row) {
+        QLabel *value = new QLabel(m_historyBox);
+        value->setAlignment(Qt::AlignRight);
+        subgrid->addWidget(new QLabel(descriptions[row], m_historyBox), row + 1, 0);
+        subgrid->addWidget(value, row + 1, 1);
+        values << value;
+    }
+    m_historyActive = values[0];
+    m_historyTaken = values[1];
+    m_historySkipped = values[2];
+    m_historyPostponed = values[3];
+    m_historyStretch = values[4];
+    mGrid->addWidget(m_historyBox, 3, 0, 1, 2);
 }
 
 RSIStatWidget::~RSIStatWidget()
@@ -65,13 +126,17 @@ RSIStatWidget::~RSIStatWidget()
 
 void RSIStatWidget::addStat(RSIStat stat, QGridLayout *grid, int row)
 {
-    QLabel *l = RSIGlobals::instance()->stats()->getDescription(stat);
-    l->setParent(this);
+    const QModelIndex description = m_model->index(stat, RSIStatsModel::DescriptionColumn);
+    QLabel *l = new QLabel(description.data().toString(), grid->parentWidget());
+    l->setWhatsThis(description.data(Qt::WhatsThisRole).toString());
 
-    QLabel *m = RSIGlobals::instance()->stats()->getLabel(stat);
-    m->setParent(grid->parentWidget());
+    QLabel *m = new QLabel(grid->parentWidget());
+    m->setWhatsThis(l->whatsThis());
     m->setAlignment(Qt::AlignRight);
 
+    m_descriptions[stat] = l;
+    m_values[stat] = m;
+
     grid->addWidget(l, row, 0);
     grid->addWidget(m, row, 1);
 
@@ -105,12 +170,70 @@ void RSIStatWidget::addStat(RSIStat stat, QGridLayout *grid, int row)
         m->setMinimumWidth(width);
 }
 
+void RSIStatWidget::setBreakColor(RSIStat stat, const QColor &color)
+{
+    m_model->setColor(stat, color);
+}
+
 void RSIStatWidget::showEvent(QShowEvent *)
 {
-    RSIGlobals::instance()->stats()->doUpdates(true);
+    m_model->setActive(true);
+    updateHistory();
 }
 
 void RSIStatWidget::hideEvent(QHideEvent *)
 {
-    RSIGlobals::instance()->stats()->doUpdates(false);
+    m_model->setActive(false);
+}
+
+void RSIStatWidget::updateRows(int first, int last)
+{
+    for (int row = first; row <= last; ++row) {
+        QLabel *value = m_values[row];
+        if (!value) {
+            continue;
+        }
+
+        // QLabel relayouts on every setText(), even with the same text.
+        const QString text = m_model->index(row, RSIStatsModel::ValueColumn).data().toString();
+        if (value->text() != text) {
+            value->setText(text);
+        }
+
+        const QColor color = m_model->index(row, RSIStatsModel::ValueColumn).data(Qt::ForegroundRole).value<QColor>();
+        if (color != m_colors[row]) {
+            m_colors[row] = color;
+            for (QLabel *label : {m_descriptions[row], value}) {
+                QPalette palette = label->palette();
+                palette.setColor(QPalette::WindowText, color.isValid() ? color : this->palette().color(QPalette::WindowText));
+                label->setPalette(palette);
+            }
+        }
+    }
+}
+
+void RSIStatWidget::updateHistory()
+{
+    RSIHistory *history = RSIGlobals::instance()->stats()->history();
+    m_historyBox->setVisible(history);
+    if (!history) {
+        return;
+    }
+
+    const QDate today = QDate::currentDate();
+    const int days = m_historyPeriod->currentData().toInt();
+    RSIHistory::Counts total;
+    int longestStretch = 0;
+    const QVector<RSIHistory::Aggregate> weeks = history->query(today.addDays(1 - days), today, RSIHistory::Grouping::Week);
+    for (const RSIHistory::Aggregate &week : weeks) {
+        total += week.counts;
+        longestStretch = std::max(longestStretch, week.longestStretch);
+    }
+
+    RSIGlobals *globals = RSIGlobals::instance();
+    m_historyActive->setText(globals->formatSeconds(static_cast<int>(total.activeSeconds)));
+    m_historyTaken->setText(QString::number(total.breaksTaken));
+    m_historySkipped->setText(QString::number(total.breaksSkipped));
+    m_historyPostponed->setText(QString::number(total.breaksPostponed));
+    m_historyStretch->setText(globals->formatSeconds(longestStretch));
 }
@@ -10,7 +10,12 @@
 
 #include "rsiglobals.h"
 
+class QComboBox;
 class QGridLayout;
+class QGroupBox;
+class QLabel;
+class RSIActivityHeatmap;
+class RSIStatsModel;
 
 class RSIStatWidget : public QWidget
 {
@@ -19,13 +24,38 @@ public:
     explicit RSIStatWidget(QWidget *parent = nullptr);
     ~RSIStatWidget();
 
+    /** Colors the time of the last break @p stat, see RSIStatsModel::setColor(). */
+    void setBreakColor(RSIStat stat, const QColor &color);
+
 protected:
     void addStat(RSIStat stat, QGridLayout *grid, int row);
     void showEvent(QShowEvent *) override;
     void hideEvent(QHideEvent *) override;
 
 private:
+    // Shows the logged history of the selected number of days.
+    void updateHistory();
+
+    // Updates the labels of the rows @p first to @p last from the model.
+    void updateRows(int first, int last);
+
     QGridLayout *mGrid;
+
+    RSIStatsModel *m_model;
+    // The labels of every RSIStat, nullptr for the ones not shown.
+    QVector<QLabel *> m_descriptions;
+    QVector<QLabel *> m_values;
+    QVector<QColor> m_colors;
+
+    RSIActivityHeatmap *m_heatmap;
+
+    QGroupBox *m_historyBox;
+    QComboBox *m_historyPeriod;
+    QLabel *m_historyActive;
+    QLabel *m_historyTaken;
+    QLabel *m_historySkipped;
+    QLabel *m_historyPostponed;
+    QLabel *m_historyStretch;
 };
 
 #endif
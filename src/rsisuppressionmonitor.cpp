@@ -0,0 +1,177 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsisuppressionmonitor.h"
+#include "platformhelper.h"
+
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusReply>
+#include <QDBusVariant>
+#include <QDebug>
+
+#include <algorithm>
+
+#include <KWindowInfo>
+#include <KX11Extras>
+
+static const QString LOGIND_SERVICE = QStringLiteral("org.freedesktop.login1");
+static const QString LOGIND_PATH = QStringLiteral("/org/freedesktop/login1");
+static const QString LOGIND_MANAGER = QStringLiteral("org.freedesktop.login1.Manager");
+static const QString PROPERTIES_INTERFACE = QStringLiteral("org.freedesktop.DBus.Properties");
+static const QString BLOCK_INHIBITED = QStringLiteral("BlockInhibited");
+
+RSISuppressionMonitor::RSISuppressionMonitor(QObject *parent)
+    : QObject(parent)
+    , m_checking(qEnvironmentVariableIsSet("RSIBREAK_CHECK_SUPPRESSION"))
+{
+    if (PlatformHelper::isX11()) {
+        KX11Extras *extras = KX11Extras::self();
+        connect(extras, &KX11Extras::windowAdded, this, [this](WId window) {
+            checkWindow(window);
+            updateFullscreen();
+        });
+        connect(extras, &KX11Extras::windowRemoved, this, &RSISuppressionMonitor::onWindowRemoved);
+        connect(extras, qOverload<WId, NET::Properties, NET::Properties2>(&KX11Extras::windowChanged), this, &RSISuppressionMonitor::onWindowChanged);
+        connect(extras, &KX11Extras::currentDesktopChanged, this, &RSISuppressionMonitor::updateFullscreen);
+
+        // The only walk over all windows, later on they are tracked one by one.
+        for (WId window : KX11Extras::windows()) {
+            checkWindow(window);
+        }
+        updateFullscreen();
+        return;
+    }
+
+    // See https://systemd.io/INHIBITOR_LOCKS/
+    m_logind = true;
+    fetchBlockInhibited();
+}
+
+bool RSISuppressionMonitor::isSuppressed()
+{
+    const bool suppressed = m_fullscreen || m_idleInhibited;
+    // For the next call, as logind does not say when inhibitors come and go.
+    if (m_logind && !m_fetching) {
+        fetchBlockInhibited();
+    }
+
+    if (m_checking && querySuppressed() != suppressed) {
+        qWarning() << "Cached suppression state is out of date";
+    }
+
+    // Breaks are asked about every second, only say when this changes.
+    if (suppressed != m_wasSuppressed) {
+        m_wasSuppressed = suppressed;
+        if (m_fullscreen) {
+            qDebug() << "Fullscreen window detected on X11, suppressing breaks";
+        } else if (m_idleInhibited) {
+            qDebug() << "Idle is inhibited, suppressing breaks";
+        } else {
+            qDebug() << "No longer suppressing breaks";
+        }
+    }
+    return suppressed;
+}
+
+bool RSISuppressionMonitor::querySuppressed()
+{
+    // X11: Check for fullscreen windows using X11 window enumeration
+    if (PlatformHelper::isX11()) {
+        for (WId win : KX11Extras::windows()) {
+            KWindowInfo info(win, NET::WMDesktop | NET::WMState | NET::XAWMState);
+            if ((info.state() & NET::FullScreen) && !info.isMinimized() && info.isOnCurrentDesktop()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Wayland: Query systemd-logind for active idle inhibitors
+    QDBusInterface logind(LOGIND_SERVICE, LOGIND_PATH, PROPERTIES_INTERFACE, QDBusConnection::systemBus());
+    if (!logind.isValid()) {
+        return false;
+    }
+
+    QDBusReply<QVariant> reply = logind.call(QStringLiteral("Get"), LOGIND_MANAGER, BLOCK_INHIBITED);
+    if (!reply.isValid()) {
+        qDebug() << "Failed to query BlockInhibited:" << reply.error().message();
+        return false;
+    }
+    return isIdleInhibited(reply.value().toString());
+}
+
+bool RSISuppressionMonitor::isIdleInhibited(const QString &inhibited)
+{
+    return inhibited.split(QLatin1Char(':')).contains(QStringLiteral("idle"));
+}
+
+void RSISuppressionMonitor::fetchBlockInhibited()
+{
+    m_fetching = true;
+    QDBusMessage message = QDBusMessage::createMethodCall(LOGIND_SERVICE, LOGIND_PATH, PROPERTIES_INTERFACE, QStringLiteral("Get"));
+    message << LOGIND_MANAGER << BLOCK_INHIBITED;
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &RSISuppressionMonitor::onBlockInhibitedFetched);
+}
+
+void RSISuppressionMonitor::onBlockInhibitedFetched(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+    m_fetching = false;
+    QDBusPendingReply<QDBusVariant> reply = *watcher;
+    if (reply.isError()) {
+        qDebug() << "Failed to query BlockInhibited:" << reply.error().message();
+        // No point in asking again every second without logind.
+        if (reply.error().type() == QDBusError::ServiceUnknown) {
+            m_logind = false;
+        }
+        return;
+    }
+    setBlockInhibited(reply.value().variant().toString());
+}
+
+void RSISuppressionMonitor::setBlockInhibited(const QString &inhibited)
+{
+    m_idleInhibited = isIdleInhibited(inhibited);
+}
+
+void RSISuppressionMonitor::onWindowChanged(WId window, NET::Properties properties, NET::Properties2 properties2)
+{
+    Q_UNUSED(properties2)
+    if (!(properties & (NET::WMState | NET::XAWMState | NET::WMDesktop))) {
+        return;
+    }
+
+    checkWindow(window);
+    updateFullscreen();
+}
+
+void RSISuppressionMonitor::onWindowRemoved(WId window)
+{
+    if (m_fullscreenWindows.remove(window)) {
+        updateFullscreen();
+    }
+}
+
+void RSISuppressionMonitor::checkWindow(WId window)
+{
+    KWindowInfo info(window, NET::WMState | NET::XAWMState);
+    if ((info.state() & NET::FullScreen) && !info.isMinimized()) {
+        m_fullscreenWindows.insert(window);
+    } else {
+        m_fullscreenWindows.remove(window);
+    }
+}
+
+void RSISuppressionMonitor::updateFullscreen()
+{
+    // Hardly ever more than one window, so asking for desktops is cheap.
+    m_fullscreen = std::any_of(m_fullscreenWindows.cbegin(), m_fullscreenWindows.cend(), [](WId window) {
+        return KWindowInfo(window, NET::WMDesktop).isOnCurrentDesktop();
+    });
+}
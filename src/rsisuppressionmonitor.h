@@ -0,0 +1,77 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSISUPPRESSIONMONITOR_H
+#define RSIBREAK_RSISUPPRESSIONMONITOR_H
+
+#include <QObject>
+#include <QSet>
+#include <qwindowdefs.h>
+
+#include <NETWM>
+
+class QDBusPendingCallWatcher;
+
+/**
+ * @class RSISuppressionMonitor
+ * Keeps track of whether breaks should be suppressed because the user is
+ * presenting: a fullscreen window on the current desktop on X11, an idle
+ * inhibitor in systemd-logind otherwise.
+ * Fullscreen windows are tracked from window manager signals. logind does not
+ * signal changes of BlockInhibited, so asking for the state starts an
+ * asynchronous refresh and answers from the last one. Asking never blocks.
+ */
+class RSISuppressionMonitor : public QObject
+{
+    Q_OBJECT
+    friend class RSISuppressionMonitorTest;
+
+public:
+    explicit RSISuppressionMonitor(QObject *parent = nullptr);
+
+    /**
+      @returns true if breaks should be suppressed right now.
+      Set RSIBREAK_CHECK_SUPPRESSION in the environment to also run
+      querySuppressed() on every call, and warn when the results differ.
+    */
+    bool isSuppressed();
+
+    /**
+      Detects suppression synchronously, with an X11 round trip per window
+      or a blocking call to systemd-logind.
+    */
+    static bool querySuppressed();
+
+    // @returns whether the colon separated BlockInhibited list of logind holds idle.
+    static bool isIdleInhibited(const QString &inhibited);
+
+private slots:
+    void onBlockInhibitedFetched(QDBusPendingCallWatcher *watcher);
+    void onWindowChanged(WId window, NET::Properties properties, NET::Properties2 properties2);
+    void onWindowRemoved(WId window);
+    void updateFullscreen();
+
+private:
+    // Asks logind for BlockInhibited without waiting for the answer.
+    void fetchBlockInhibited();
+    void setBlockInhibited(const QString &inhibited);
+
+    // Adds or removes @p window from the fullscreen windows, by its state.
+    void checkWindow(WId window);
+
+    bool m_checking;
+    bool m_fullscreen = false;
+    bool m_idleInhibited = false;
+    // Whether BlockInhibited is asked from logind, off on X11.
+    bool m_logind = false;
+    // One fetch at a time, however often the state is asked for.
+    bool m_fetching = false;
+    // As last returned by isSuppressed().
+    bool m_wasSuppressed = false;
+
+    // Fullscreen windows which are not minimized, on any desktop.
+    QSet<WId> m_fullscreenWindows;
+};
+
+#endif // RSIBREAK_RSISUPPRESSIONMONITOR_H
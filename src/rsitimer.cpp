@@ -10,12 +10,14 @@
 */
 
 #include "rsitimer.h"
-#include "platformhelper.h"
 
 #include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+#include <tuple>
 
-#include <QDBusInterface>
-#include <QDBusReply>
+#include <QColor>
 #include <QDebug>
 #include <QTimer>
 
@@ -23,17 +25,35 @@
 #include <kconfiggroup.h>
 #include <ksharedconfig.h>
 
-// X11-specific includes
-#include <KWindowInfo>
-#include <KX11Extras>
-#include <NETWM>
-
 #include "rsiglobals.h"
 #include "rsistats.h"
 
+// Tolerance for a timer firing a little early, coarse timers may be 5% off.
+static constexpr int TICK_SLACK_MS = 100;
+
+// Upper bound for planning ahead, the plan is redone after that.
+static constexpr int MAX_DEADLINE_TICKS = 60 * 60;
+
+// Input events in a second which weigh as much as the second itself.
+static constexpr int INTENSITY_REFERENCE_EVENTS = 4;
+// Bounds of the load of an active second, in thousandths of a tick.
+static constexpr int INTENSITY_MIN_LOAD = 500;
+static constexpr int INTENSITY_MAX_LOAD = 2000;
+
+// Wall clock offset changes below this are taken for drift, not a jump.
+static constexpr int WALL_CLOCK_JUMP_MS = 1000;
+
+// Granularity of the tooltip text: KFormat spells out minutes and seconds
+// below an hour, and only hours and minutes above.
+static int tooltipBucket(const int secondsLeft)
+{
+    return secondsLeft < 3600 ? secondsLeft : 3600 + secondsLeft / 60;
+}
+
 RSITimer::RSITimer(QObject *parent)
     : QObject(parent)
-    , m_idleTimeInstance(new RSIIdleTimeImpl())
+    , m_idleTimeInstance(RSIIdleTime::create(idleBackend()))
+    , m_clock(new RSIClockImpl())
     , m_intervals(RSIGlobals::instance()->intervals())
     , m_state(TimerState::Monitoring)
 {
@@ -41,9 +61,14 @@ RSITimer::RSITimer(QObject *parent)
     run();
 }
 
-RSITimer::RSITimer(std::unique_ptr<RSIIdleTime> &&_idleTime, const QVector<int> _intervals, const bool _usePopup, const bool _useIdleTimers)
+RSITimer::RSITimer(std::unique_ptr<RSIIdleTime> &&_idleTime,
+                   const QVector<int> _intervals,
+                   const bool _usePopup,
+                   const bool _useIdleTimers,
+                   std::unique_ptr<RSIClock> &&_clock)
     : QObject(nullptr)
     , m_idleTimeInstance(std::move(_idleTime))
+    , m_clock(_clock ? std::move(_clock) : std::unique_ptr<RSIClock>{new RSIClockImpl()})
     , m_usePopup(_usePopup)
     , m_useIdleTimers(_useIdleTimers)
     , m_intervals(_intervals)
@@ -55,26 +80,67 @@ RSITimer::RSITimer(std::unique_ptr<RSIIdleTime> &&_idleTime, const QVector<int>
 
 void RSITimer::createTimers()
 {
-    int bigThreshold = m_useIdleTimers ? m_intervals[BIG_BREAK_THRESHOLD] : INT_MAX;
-    int tinyThreshold = m_useIdleTimers ? m_intervals[TINY_BREAK_THRESHOLD] : INT_MAX;
+    m_breakTiers.clear();
+    m_breakIndex = -1;
+    m_intensityCarry = 0;
+
+    const int bigDuration = m_intervals[BIG_BREAK_DURATION];
+    for (int tier = 0; tier < RSIGlobals::tierCount(m_intervals); ++tier) {
+        const int interval = m_intervals[RSIGlobals::tierSlot(tier, TIER_INTERVAL)];
+        const int duration = m_intervals[RSIGlobals::tierSlot(tier, TIER_DURATION)];
+        const int threshold = m_useIdleTimers ? m_intervals[RSIGlobals::tierSlot(tier, TIER_THRESHOLD)] : INT_MAX;
+        // Every tier but the big breaks can be turned off.
+        if (interval == 0 && tier != BIG_TIER) {
+            continue;
+        }
+        // Breaks at least as long as the big ones count as big ones.
+        const bool isLong = tier == BIG_TIER || (tier != TINY_TIER && duration >= bigDuration);
+        m_breakTiers.push_back({tier, RSITimerCounter(interval, duration, threshold), isLong});
+    }
+    m_plannedTiers = m_breakTiers;
+}
 
-    m_bigBreakCounter = std::unique_ptr<RSITimerCounter>{new RSITimerCounter(m_intervals[BIG_BREAK_INTERVAL], m_intervals[BIG_BREAK_DURATION], bigThreshold)};
-    m_tinyBreakCounter = !m_intervals[TINY_BREAK_INTERVAL]
-        ? nullptr
-        : std::unique_ptr<RSITimerCounter>{new RSITimerCounter(m_intervals[TINY_BREAK_INTERVAL], m_intervals[TINY_BREAK_DURATION], tinyThreshold)};
+QString RSITimer::idleBackend()
+{
+    const QStringList backends = RSIIdleTime::backends();
+    const QString backend = KSharedConfig::openConfig()->group("General Settings").readEntry("IdleBackend", backends.constFirst());
+    return backends.contains(backend) ? backend : backends.constFirst();
 }
 
-void RSITimer::run()
+void RSITimer::connectIdleTime()
 {
     connect(m_idleTimeInstance.get(), &RSIIdleTime::idleTimeoutReached, this, &RSITimer::onIdleTimeoutReached);
     connect(m_idleTimeInstance.get(), &RSIIdleTime::resumingFromIdle, this, &RSITimer::onResumingFromIdle);
 
     registerIdleTimeouts();
+}
+
+void RSITimer::run()
+{
+    connectIdleTime();
+
+    m_tickTimer = new QTimer(this);
+    connect(m_tickTimer, &QTimer::timeout, this, &RSITimer::onTickTimer);
+    startTickTimer();
+}
 
-    auto timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &RSITimer::timeout);
-    timer->setTimerType(Qt::TimerType::CoarseTimer);
-    timer->start(1000);
+void RSITimer::startTickTimer()
+{
+    m_lastTickMs = m_clock->monotonicMSecs();
+    m_lastCheckMonotonicMs = m_lastTickMs;
+    m_lastCheckBoottimeMs = m_clock->boottimeMSecs();
+
+    if (m_useDeadlineScheduler) {
+        // Single wakeups far apart, so they have to be on time.
+        m_tickTimer->setSingleShot(true);
+        m_tickTimer->setTimerType(Qt::TimerType::PreciseTimer);
+        scheduleNextDeadline();
+    } else {
+        m_tickTimer->setSingleShot(false);
+        m_tickTimer->setTimerType(Qt::TimerType::CoarseTimer);
+        m_tickTimer->start(1000);
+        // Late or missed timeouts are made up for in catchUp().
+    }
 }
 
 void RSITimer::registerIdleTimeouts()
@@ -82,7 +148,25 @@ void RSITimer::registerIdleTimeouts()
     m_idleTimeInstance->removeAllIdleTimeouts();
 
     // Register for 1 second to detect when user becomes idle
-    m_idleTimeInstance->addIdleTimeout(1000);
+    QVector<int> timeouts = {1000};
+
+    // The idle backend tells when a threshold is reached, so nothing has to
+    // wake up every second to find out.
+    if (m_useIdleTimers) {
+        for (const BreakTier &breakTier : m_breakTiers) {
+            timeouts.append(breakTier.counter.getResetThreshold() * 1000);
+        }
+    }
+
+    std::sort(timeouts.begin(), timeouts.end());
+    timeouts.erase(std::unique(timeouts.begin(), timeouts.end()), timeouts.end());
+    for (const int msec : std::as_const(timeouts)) {
+        if (msec >= 1000) {
+            m_idleTimeInstance->addIdleTimeout(msec);
+        }
+    }
+    // Timeouts added while idle only fire after the next activity.
+    m_idleTimeoutsArmed = !m_isIdle;
 
     // Catch resume events to know when user becomes active
     m_idleTimeInstance->catchNextResumeEvent();
@@ -90,97 +174,462 @@ void RSITimer::registerIdleTimeouts()
 
 void RSITimer::onIdleTimeoutReached(int msec)
 {
-    Q_UNUSED(msec)
+    catchUp();
     if (!m_isIdle) {
         m_isIdle = true;
-        m_idleStartTime = QDateTime::currentDateTime();
+        m_idleStartMs = m_clock->monotonicMSecs();
+    }
+
+    // Idle past a threshold, the counter resets right away instead of on the
+    // tick that would notice. Breaks end on the pause counter instead, the
+    // idle time can include idling from before the break started.
+    if (m_state == TimerState::Monitoring) {
+        int longSkips = 0;
+        int shortSkips = 0;
+        for (BreakTier &breakTier : m_breakTiers) {
+            if (!breakTier.counter.isReset() && msec >= breakTier.counter.getResetThreshold() * 1000LL) {
+                breakTier.counter.reset();
+                ++(breakTier.isLong ? longSkips : shortSkips);
+            }
+        }
+        if (longSkips > 0 || shortSkips > 0) {
+            countIdleSkips(longSkips, shortSkips);
+            publishSnapshot(idleTime());
+        }
     }
+    scheduleNextDeadline();
 }
 
 void RSITimer::onResumingFromIdle()
 {
+    catchUp();
     m_isIdle = false;
+    m_idleTimeoutsArmed = true;
+    scheduleNextDeadline();
 }
 
 bool RSITimer::suppressionDetector()
 {
-    // X11: Check for fullscreen windows using X11 window enumeration
-    if (PlatformHelper::isX11()) {
-        for (WId win : KX11Extras::windows()) {
-            KWindowInfo info(win, NET::WMDesktop | NET::WMState | NET::XAWMState);
-            if ((info.state() & NET::FullScreen) && !info.isMinimized() && info.isOnCurrentDesktop()) {
-                qDebug() << "Fullscreen window detected on X11, suppressing break";
-                return true;
-            }
+    return m_suppressionMonitor && m_suppressionMonitor->isSuppressed();
+}
+
+bool RSITimer::suspendDetector()
+{
+    // CLOCK_BOOTTIME keeps counting during suspend-to-RAM and CLOCK_MONOTONIC
+    // does not, while a stalled event loop moves both alike.
+    const qint64 monotonic = m_clock->monotonicMSecs();
+    const qint64 boottime = m_clock->boottimeMSecs();
+    const qint64 suspendedMs = (boottime - m_lastCheckBoottimeMs) - (monotonic - m_lastCheckMonotonicMs);
+    m_lastCheckMonotonicMs = monotonic;
+    m_lastCheckBoottimeMs = boottime;
+
+    if (suspendedMs > 60 * 1000) {
+        qDebug() << "The computer was suspended for" << suspendedMs / 1000 << "seconds, resetting timers";
+        return true;
+    }
+    return false;
+}
+
+int RSITimer::idleSecondsAt(qint64 clockMs) const
+{
+    if (!m_isIdle) {
+        return 0;
+    }
+    const qint64 idleMs = clockMs - m_idleStartMs;
+    return idleMs > 0 ? idleMs / 1000 : 0;
+}
+
+int RSITimer::idleTime() const
+{
+    return idleSecondsAt(m_clock->monotonicMSecs());
+}
+
+void RSITimer::catchUp()
+{
+    if (!m_tickTimer) {
+        return;
+    }
+
+    if (suspendDetector() && m_state != TimerState::Suspended) {
+        for (BreakTier &breakTier : m_breakTiers) {
+            breakTier.counter.reset();
+        }
+        transition(TimerEvent::BreakOver);
+    }
+
+    // Apply every whole second that passed on the monotonic clock, so
+    // a stalled or late timer does not lose any time.
+    const qint64 now = m_clock->monotonicMSecs();
+    const int ticks = (now - m_lastTickMs + TICK_SLACK_MS) / 1000;
+    if (ticks <= 0) {
+        return;
+    }
+    m_lastTickMs += ticks * 1000LL;
+
+    // Suspended seconds are not accounted for, same as in timeout().
+    if (m_state == TimerState::Suspended) {
+        return;
+    }
+
+    meterInputIntensity(ticks);
+    syncWallClock(now);
+    advanceTicks(m_lastTickMs - (ticks - 1) * 1000LL, ticks);
+}
+
+void RSITimer::syncWallClock(const qint64 clockMs)
+{
+    // Only followed on a jump, like after suspend or setting the clock, so
+    // that consecutive ticks end on consecutive seconds in the activity log.
+    const qint64 offset = QDateTime::currentMSecsSinceEpoch() - clockMs;
+    if (std::abs(offset - m_wallOffsetMs) > WALL_CLOCK_JUMP_MS) {
+        m_wallOffsetMs = offset;
+    }
+}
+
+void RSITimer::meterInputIntensity(const int ticks)
+{
+    const quint32 events = m_idleTimeInstance->takeInputEvents();
+    if (!m_useInputIntensity || m_isIdle || m_state != TimerState::Monitoring) {
+        return;
+    }
+
+    const qint64 load = std::clamp<qint64>(events * 1000LL / (INTENSITY_REFERENCE_EVENTS * (qint64)ticks), INTENSITY_MIN_LOAD, INTENSITY_MAX_LOAD);
+    m_intensityCarry += (load - 1000) * ticks;
+    const qint64 extraTicks = m_intensityCarry / 1000;
+    if (extraTicks == 0) {
+        return;
+    }
+    m_intensityCarry -= extraTicks * 1000;
+    for (BreakTier &breakTier : m_breakTiers) {
+        breakTier.counter.addLoad((int)std::clamp<qint64>(extraTicks, -INT_MAX / 2, INT_MAX / 2));
+    }
+}
+
+void RSITimer::advanceTicks(qint64 firstTickMs, int ticks)
+{
+    while (ticks > 0) {
+        // While the idle state holds, the counters are predictable, so
+        // everything up to the next state change is done in one step. The
+        // last tick always goes through processTick() to update the tooltip,
+        // tray icon and break widget.
+        int bulk = 0;
+        const int idleSeconds = idleSecondsAt(firstTickMs);
+        if (!m_isIdle || firstTickMs >= m_idleStartMs) {
+            bulk = std::min(ticks - 1, ticksWithoutTransition(idleSeconds));
+        }
+
+        if (bulk > 0) {
+            applyTicks(firstTickMs, bulk, idleSeconds);
+        } else {
+            processTick(firstTickMs, idleSeconds, ticks > 1);
+            bulk = 1;
         }
-        return false;
+
+        firstTickMs += bulk * 1000LL;
+        ticks -= bulk;
+    }
+}
+
+int RSITimer::ticksWithoutTransition(const int idleSeconds) const
+{
+    switch (m_state) {
+    case TimerState::Monitoring: {
+        int ticks = INT_MAX;
+        for (const BreakTier &breakTier : m_breakTiers) {
+            ticks = std::min(ticks, breakTier.counter.ticksToBreak(idleSeconds, m_isIdle) - 1);
+        }
+        return ticks;
+    }
+    case TimerState::Suggesting: {
+        // The pause only counts down undisturbed until the short input
+        // counter signals long input.
+        return std::min({m_popupCounter.ticksToBreak(idleSeconds, m_isIdle),
+                         m_shortInputCounter.ticksToBreak(idleSeconds, m_isIdle),
+                         m_pauseCounter.ticksToBreak(0, false)})
+            - 1;
+    }
+    case TimerState::Resting:
+        // The pause counter is never reset while resting, input or not.
+        return m_pauseCounter.ticksToBreak(0, false) - 1;
+    default:
+        return 0;
     }
+}
 
-    // Wayland: Query systemd-logind for active idle inhibitors
-    // See https://systemd.io/INHIBITOR_LOCKS/
-    QDBusInterface logind(QStringLiteral("org.freedesktop.login1"),
-                          QStringLiteral("/org/freedesktop/login1"),
-                          QStringLiteral("org.freedesktop.DBus.Properties"),
-                          QDBusConnection::systemBus());
+void RSITimer::applyTicks(const qint64 firstTickMs, const int ticks, const int idleSeconds)
+{
+    accountTicks(firstTickMs + (ticks - 1) * 1000LL, ticks, idleSeconds, m_isIdle);
 
-    if (!logind.isValid()) {
-        qDebug() << "Could not connect to systemd-logind for inhibitor detection";
-        return false;
+    switch (m_state) {
+    case TimerState::Monitoring: {
+        int longSkips = 0;
+        int shortSkips = 0;
+        for (BreakTier &breakTier : m_breakTiers) {
+            const bool wasReset = breakTier.counter.isReset();
+            breakTier.counter.advance(ticks, idleSeconds, m_isIdle);
+            if (!wasReset && breakTier.counter.isReset()) {
+                ++(breakTier.isLong ? longSkips : shortSkips);
+            }
+        }
+        countIdleSkips(longSkips, shortSkips);
+        break;
     }
+    case TimerState::Suggesting:
+        m_popupCounter.advance(ticks, idleSeconds, m_isIdle);
+        [[fallthrough]];
+    case TimerState::Resting:
+        m_shortInputCounter.advance(ticks, idleSeconds, m_isIdle);
+        m_pauseCounter.advance(ticks, 0, false);
+        break;
+    default:
+        break;
+    }
+}
 
-    // Get the BlockInhibited property which contains a colon-separated list
-    // of inhibited actions (e.g., "idle:sleep:shutdown")
-    QDBusReply<QVariant> reply = logind.call(QStringLiteral("Get"), QStringLiteral("org.freedesktop.login1.Manager"), QStringLiteral("BlockInhibited"));
+void RSITimer::accountTicks(const qint64 lastTickMs, const int ticks, const int idleSeconds, const bool idleGrows)
+{
+    // Only the first tick can be active while idle, that's when idling started.
+    const int lastIdle = idleGrows ? idleSeconds + ticks - 1 : idleSeconds;
+    int activeTicks = 0;
+    if (idleSeconds == 0) {
+        activeTicks = idleGrows ? 1 : ticks;
+    }
+    const int idleTicks = ticks - activeTicks;
+
+    // Active seconds come first, so they end before the idle ones.
+    const qint64 end = (lastTickMs + m_wallOffsetMs) / 1000;
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    stats->increaseStat(TOTAL_TIME, ticks);
+    stats->setCounter(CURRENT_IDLE_TIME, lastIdle);
+    if (activeTicks > 0) {
+        stats->increaseStat(ACTIVITY, activeTicks, end - idleTicks);
+    }
+    if (idleTicks > 0) {
+        // Setting MAX_IDLENESS accounts one second of IDLENESS.
+        stats->setCounter(MAX_IDLENESS, lastIdle, true, end - idleTicks + 1);
+        if (idleTicks > 1) {
+            stats->increaseStat(IDLENESS, idleTicks - 1, end);
+        }
+    }
+}
 
-    if (!reply.isValid()) {
-        qDebug() << "Failed to query BlockInhibited:" << reply.error().message();
-        return false;
+void RSITimer::countIdleSkips(const int longSkips, const int shortSkips)
+{
+    // Counters got reset without a break, that means we were idle enough to skip.
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    if (longSkips > 0) {
+        stats->increaseStat(BIG_BREAKS, longSkips);
+        stats->increaseStat(IDLENESS_CAUSED_SKIP_BIG, longSkips);
     }
+    if (shortSkips > 0) {
+        stats->increaseStat(TINY_BREAKS, shortSkips);
+        stats->increaseStat(IDLENESS_CAUSED_SKIP_TINY, shortSkips);
+    }
+}
 
-    QString inhibited = reply.value().toString();
-    bool idleInhibited = inhibited.split(QLatin1Char(':')).contains(QStringLiteral("idle"));
+void RSITimer::slotReschedule()
+{
+    catchUp();
+    scheduleNextDeadline();
+}
+
+void RSITimer::scheduleNextDeadline()
+{
+    if (!m_useDeadlineScheduler || !m_tickTimer) {
+        return;
+    }
 
-    if (idleInhibited) {
-        qDebug() << "Idle is inhibited, suppressing break. Active inhibitors:" << inhibited;
+    const int ticks = ticksToNextDeadline();
+    if (ticks == 0) {
+        // Nothing changes until the idle state does, which replans.
+        m_tickTimer->stop();
+        return;
     }
+    const qint64 due = m_lastTickMs + ticks * 1000LL - m_clock->monotonicMSecs();
+    m_tickTimer->start(std::max<qint64>(due, 0));
+}
+
+double RSITimer::idleAvg(const int tinyLeft, const int bigLeft) const
+{
+    const double rawvalue = tierCounter(TINY_TIER) ? tinyLeft / (double)m_intervals[TINY_BREAK_INTERVAL] : bigLeft / (double)m_intervals[BIG_BREAK_INTERVAL];
+    return 100.0 - (rawvalue * 100.0);
+}
 
-    return idleInhibited;
+std::tuple<int, int, QRgb, QRgb, int> RSITimer::trayView(const int tinyLeft, const int bigLeft) const
+{
+    RSIGlobals *globals = RSIGlobals::instance();
+    return std::make_tuple(tooltipBucket(tinyLeft),
+                           tooltipBucket(bigLeft),
+                           globals->getTinyBreakColor(tinyLeft).rgb(),
+                           globals->getBigBreakColor(bigLeft).rgb(),
+                           RSIGlobals::iconLevel(idleAvg(tinyLeft, bigLeft)));
+}
+
+void RSITimer::publishSnapshot(const int idleSeconds)
+{
+    RSITimerSnapshot snapshot;
+    snapshot.state = (int)m_state;
+    snapshot.idleSeconds = idleSeconds;
+    switch (m_state) {
+    case TimerState::Suggesting:
+        snapshot.relaxLeft = m_pauseCounter.counterLeft();
+        snapshot.patienceLeft = m_popupCounter.counterLeft();
+        snapshot.nextBreakIsBig = m_nextBreakIsBig;
+        [[fallthrough]];
+    case TimerState::Resting:
+        snapshot.breakLeft = m_pauseCounter.counterLeft();
+        [[fallthrough]];
+    case TimerState::Monitoring:
+        snapshot.tinyLeft = tinyLeft();
+        snapshot.bigLeft = bigLeft();
+        break;
+    default:
+        // Suspended timers show no counters.
+        break;
+    }
+    const auto tray = trayView(snapshot.tinyLeft, snapshot.bigLeft);
+    snapshot.iconLevel = m_state == TimerState::Suspended ? 0 : std::get<4>(tray);
+
+    // The idle seconds alone are not worth a queued event.
+    auto visible = [](const RSITimerSnapshot &s) {
+        return std::make_tuple(s.state, s.breakLeft, s.relaxLeft, s.patienceLeft, s.nextBreakIsBig, s.iconLevel);
+    };
+    if (visible(snapshot) == visible(m_snapshot) && tray == trayView(m_snapshot.tinyLeft, m_snapshot.bigLeft)) {
+        return;
+    }
+    m_snapshot = snapshot;
+    emit snapshotChanged(m_snapshot);
 }
 
-void RSITimer::hibernationDetector(const int totalIdle)
+int RSITimer::ticksToNextDeadline()
 {
-    // poor mans hibernation detector....
-    static QDateTime last = QDateTime::currentDateTime();
-    QDateTime current = QDateTime::currentDateTime();
-    if (last.secsTo(current) > 60) {
-        qDebug() << "Not been checking idleTime for more than 60 seconds, "
-                 << "assuming the computer hibernated, resetting timers"
-                 << "Last: " << last << "Current: " << current << "Idle, s: " << totalIdle;
-        m_bigBreakCounter->reset();
-        if (m_tinyBreakCounter) {
-            m_tinyBreakCounter->reset();
+    if (m_state == TimerState::Suspended) {
+        return 0;
+    }
+
+    // Breaks count down on screen, and so does the statistics widget.
+    if (m_state != TimerState::Monitoring || RSIGlobals::instance()->stats()->isUpdating()) {
+        return 1;
+    }
+
+    // Play the counters forward on copies, with the idle state as it is now.
+    // The copy reuses the scratch storage, so this does not allocate.
+    m_plannedTiers = m_breakTiers;
+    std::vector<BreakTier> &tiers = m_plannedTiers;
+    auto left = [&tiers](const int tier) {
+        for (const BreakTier &breakTier : tiers) {
+            if (breakTier.tier == tier) {
+                return breakTier.counter.counterLeft();
+            }
+        }
+        return 0;
+    };
+    const auto shown = trayView(left(TINY_TIER), left(BIG_TIER));
+
+    for (int ticks = 1; ticks <= MAX_DEADLINE_TICKS; ++ticks) {
+        const int idleSeconds = idleSecondsAt(m_lastTickMs + ticks * 1000LL);
+        bool changed = false;
+        bool allReset = true;
+        for (BreakTier &breakTier : tiers) {
+            const int leftBefore = breakTier.counter.counterLeft();
+            const bool wasReset = breakTier.counter.isReset();
+            if (breakTier.counter.tick(idleSeconds) > 0) {
+                return ticks;
+            }
+            if (!wasReset && breakTier.counter.isReset()) {
+                // Unless the threshold is behind already, its idle timeout
+                // comes first and plans again.
+                const bool notified = m_idleTimeoutsArmed && idleSecondsAt(m_lastTickMs) < breakTier.counter.getResetThreshold();
+                return notified ? 0 : ticks;
+            }
+            changed = changed || breakTier.counter.counterLeft() != leftBefore;
+            allReset = allReset && breakTier.counter.isReset();
+        }
+
+        if (!changed) {
+            // Idle past all thresholds, the counters stay reset from now on.
+            if (m_isIdle && allReset) {
+                return 0;
+            }
+            continue;
+        }
+        if (trayView(left(TINY_TIER), left(BIG_TIER)) != shown) {
+            return ticks;
         }
-        resetAfterBreak();
     }
-    last = current;
+    return MAX_DEADLINE_TICKS;
 }
 
-int RSITimer::idleTime()
+void RSITimer::transition(const TimerEvent event, const int breakTime)
 {
-    int totalIdle = 0;
-    if (m_isIdle) {
-        totalIdle = m_idleStartTime.secsTo(QDateTime::currentDateTime());
+    static const struct {
+        TimerState from;
+        TimerEvent event;
+        TimerState to;
+        void (RSITimer::*enter)(const int breakTime);
+    } transitions[] = {
+        {TimerState::Monitoring, TimerEvent::BreakDue, TimerState::Suggesting, &RSITimer::startSuggesting},
+        {TimerState::Monitoring, TimerEvent::BreakNow, TimerState::Resting, &RSITimer::startResting},
+        {TimerState::Suggesting, TimerEvent::BreakNow, TimerState::Resting, &RSITimer::startRestingAfterPatience},
+        {TimerState::Monitoring, TimerEvent::BreakOver, TimerState::Monitoring, &RSITimer::finishBreak},
+        {TimerState::Suggesting, TimerEvent::BreakOver, TimerState::Monitoring, &RSITimer::finishBreak},
+        {TimerState::Resting, TimerEvent::BreakOver, TimerState::Monitoring, &RSITimer::finishBreak},
+        // Locking the screen ends a suspension as well.
+        {TimerState::Suspended, TimerEvent::BreakOver, TimerState::Monitoring, &RSITimer::finishBreak},
+        {TimerState::Suspended, TimerEvent::Stop, TimerState::Suspended, &RSITimer::stopped},
+        {TimerState::Monitoring, TimerEvent::Stop, TimerState::Suspended, &RSITimer::stopped},
+        {TimerState::Suggesting, TimerEvent::Stop, TimerState::Suspended, &RSITimer::stopped},
+        {TimerState::Resting, TimerEvent::Stop, TimerState::Suspended, &RSITimer::stopped},
+        {TimerState::Suspended, TimerEvent::Start, TimerState::Monitoring, nullptr},
+        {TimerState::Monitoring, TimerEvent::Start, TimerState::Monitoring, nullptr},
+        {TimerState::Suggesting, TimerEvent::Start, TimerState::Monitoring, nullptr},
+        {TimerState::Resting, TimerEvent::Start, TimerState::Monitoring, nullptr},
+    };
+
+    for (const auto &row : transitions) {
+        if (row.from == m_state && row.event == event) {
+            m_state = row.to;
+            if (row.enter) {
+                (this->*row.enter)(breakTime);
+            }
+            publishSnapshot(idleTime());
+            return;
+        }
     }
-    hibernationDetector(totalIdle);
-    return totalIdle;
+    qDebug() << "Unexpected timer event" << (int)event << "in state" << (int)m_state;
+}
+
+void RSITimer::startSuggesting(const int breakTime)
+{
+    // When pause is longer than patience, we need to reset patience timer so that we don't flip to break now in
+    // mid-pause. Patience / 2 is a good alternative to it by extending patience if user was idle long enough.
+    m_popupCounter = RSITimerCounter(m_intervals[PATIENCE_INTERVAL], breakTime, m_intervals[PATIENCE_INTERVAL] / 2);
+    // Threshold of one means the timer is reset on every non-zero tick.
+    m_pauseCounter = RSITimerCounter(breakTime, breakTime, 1);
+
+    // For measuring input duration in order to limit influence of short inputs on resetting pause counter.
+    // Example of short input is: mouse sent input due to accidental touch or desk vibration.
+    m_shortInputCounter = RSITimerCounter(m_intervals[SHORT_INPUT_INTERVAL], 1, 1);
+
+    m_nextBreakIsBig = nextBreakIsBig();
+    emit relax(breakTime, m_nextBreakIsBig);
+}
+
+void RSITimer::startResting(const int breakTime)
+{
+    doBreakNow(breakTime, nextBreakIsBig());
+}
+
+void RSITimer::startRestingAfterPatience(const int breakTime)
+{
+    emit relax(-1, false);
+    doBreakNow(breakTime, false);
 }
 
 void RSITimer::doBreakNow(const int breakTime, const bool nextBreakIsBig)
 {
-    m_state = TimerState::Resting;
-    m_pauseCounter = std::unique_ptr<RSITimerCounter>{new RSITimerCounter(breakTime, breakTime, INT_MAX)};
-    m_popupCounter = nullptr;
-    m_shortInputCounter = std::unique_ptr<RSITimerCounter>{new RSITimerCounter(m_intervals[SHORT_INPUT_INTERVAL], 1, 1)};
+    m_pauseCounter = RSITimerCounter(breakTime, breakTime, INT_MAX);
+    m_shortInputCounter = RSITimerCounter(m_intervals[SHORT_INPUT_INTERVAL], 1, 1);
     if (nextBreakIsBig) {
         emit startLongBreak();
     } else {
@@ -190,35 +639,101 @@ void RSITimer::doBreakNow(const int breakTime, const bool nextBreakIsBig)
     emit breakNow();
 }
 
-void RSITimer::resetAfterBreak()
+void RSITimer::finishBreak(const int breakTime)
 {
-    m_state = TimerState::Monitoring;
-    m_pauseCounter = nullptr;
-    m_popupCounter = nullptr;
-    m_shortInputCounter = nullptr;
+    Q_UNUSED(breakTime)
     defaultUpdateToolTip();
     emit updateIdleAvg(0.0);
     emit relax(-1, false);
     emit minimize();
-    if (m_bigBreakCounter->isReset()) {
+    if (isLongBreak()) {
         emit endLongBreak();
     } else {
         emit endShortBreak();
     }
+    m_breakIndex = -1;
+}
+
+void RSITimer::stopped(const int breakTime)
+{
+    Q_UNUSED(breakTime)
+    emit updateIdleAvg(0.0);
+    emit updateToolTip(0, 0);
+}
+
+bool RSITimer::nextBreakIsBig() const
+{
+    // The next break is a long one if one is due before any short one can be.
+    int longLeft = INT_MAX;
+    int shortDelay = INT_MAX;
+    for (const BreakTier &breakTier : m_breakTiers) {
+        if (breakTier.isLong) {
+            longLeft = std::min(longLeft, breakTier.counter.counterLeft());
+        } else {
+            shortDelay = std::min(shortDelay, breakTier.counter.getDelayTicks());
+        }
+    }
+    return shortDelay == INT_MAX || longLeft <= shortDelay;
+}
+
+bool RSITimer::isLongBreak() const
+{
+    if (m_breakIndex >= 0) {
+        return m_breakTiers[m_breakIndex].isLong;
+    }
+    // No break in progress, so it's about the last one.
+    return tierCounter(BIG_TIER)->isReset();
+}
+
+int RSITimer::tierLeftAt(const int tier, const qint64 clockMs) const
+{
+    const RSITimerCounter *counter = tierCounter(tier);
+    if (!counter) {
+        return 0;
+    }
+    const qint64 ticks = (clockMs - m_lastTickMs + TICK_SLACK_MS) / 1000;
+    if (!m_tickTimer || ticks <= 0 || m_state != TimerState::Monitoring) {
+        return counter->counterLeft();
+    }
+
+    RSITimerCounter projected = *counter;
+    const qint64 firstTickMs = m_lastTickMs + 1000;
+    // The counter starts over on a break, but the break was not taken yet.
+    if (projected.advance((int)std::min<qint64>(ticks, INT_MAX / 2), idleSecondsAt(firstTickMs), m_isIdle) > 0) {
+        return 0;
+    }
+    return projected.counterLeft();
+}
+
+const RSITimerCounter *RSITimer::tierCounter(const int tier) const
+{
+    for (const BreakTier &breakTier : m_breakTiers) {
+        if (breakTier.tier == tier) {
+            return &breakTier.counter;
+        }
+    }
+    return nullptr;
+}
+
+RSITimerCounter *RSITimer::tierCounter(const int tier)
+{
+    return const_cast<RSITimerCounter *>(std::as_const(*this).tierCounter(tier));
 }
 
 // -------------------------- SLOTS ------------------------//
 
 void RSITimer::slotStart()
 {
-    m_state = TimerState::Monitoring;
+    catchUp();
+    transition(TimerEvent::Start);
+    scheduleNextDeadline();
 }
 
 void RSITimer::slotStop()
 {
-    m_state = TimerState::Suspended;
-    emit updateIdleAvg(0.0);
-    emit updateToolTip(0, 0);
+    catchUp();
+    transition(TimerEvent::Stop);
+    scheduleNextDeadline();
 }
 
 void RSITimer::slotSuspended(bool suspend)
@@ -228,44 +743,89 @@ void RSITimer::slotSuspended(bool suspend)
 
 void RSITimer::slotLock()
 {
-    resetAfterBreak();
+    catchUp();
+    transition(TimerEvent::BreakOver);
+    scheduleNextDeadline();
 }
 
 void RSITimer::skipBreak()
 {
-    if (m_bigBreakCounter->isReset()) {
+    catchUp();
+    if (isLongBreak()) {
         RSIGlobals::instance()->stats()->increaseStat(BIG_BREAKS_SKIPPED);
         emit bigBreakSkipped();
     } else {
         RSIGlobals::instance()->stats()->increaseStat(TINY_BREAKS_SKIPPED);
         emit tinyBreakSkipped();
     }
-    resetAfterBreak();
+    transition(TimerEvent::BreakOver);
+    scheduleNextDeadline();
 }
 
 void RSITimer::postponeBreak()
 {
-    if (m_bigBreakCounter->isReset()) {
-        m_bigBreakCounter->postpone(m_intervals[POSTPONE_BREAK_INTERVAL]);
-        RSIGlobals::instance()->stats()->increaseStat(BIG_BREAKS_POSTPONED);
-    } else {
-        m_tinyBreakCounter->postpone(m_intervals[POSTPONE_BREAK_INTERVAL]);
-        RSIGlobals::instance()->stats()->increaseStat(TINY_BREAKS_POSTPONED);
+    catchUp();
+    // Only a break in progress can be postponed.
+    if (m_breakIndex >= 0) {
+        BreakTier &breakTier = m_breakTiers[m_breakIndex];
+        breakTier.counter.postpone(m_intervals[POSTPONE_BREAK_INTERVAL]);
+        RSIGlobals::instance()->stats()->increaseStat(breakTier.isLong ? BIG_BREAKS_POSTPONED : TINY_BREAKS_POSTPONED);
     }
-    resetAfterBreak();
+    transition(TimerEvent::BreakOver);
+    scheduleNextDeadline();
 }
 
 void RSITimer::updateConfig(bool doRestart)
 {
+    catchUp();
+
     KConfigGroup popupConfig = KSharedConfig::openConfig()->group("Popup Settings");
     m_usePopup = popupConfig.readEntry("UsePopup", true);
 
     bool oldUseIdleTimers = m_useIdleTimers;
     KConfigGroup generalConfig = KSharedConfig::openConfig()->group("General Settings");
     m_suppressable = generalConfig.readEntry("SuppressIfPresenting", true);
+    if (!m_suppressable) {
+        m_suppressionMonitor.reset();
+    } else if (!m_suppressionMonitor) {
+        m_suppressionMonitor.reset(new RSISuppressionMonitor());
+    }
     m_useIdleTimers = !(generalConfig.readEntry("UseNoIdleTimer", false));
+
+    // A new idle backend starts out with the user active.
+    const QString backend = idleBackend();
+    if (m_tickTimer && !m_idleTimeInstance->objectName().isEmpty() && m_idleTimeInstance->objectName() != backend) {
+        qDebug() << "Switching the idle backend to" << backend;
+        m_idleTimeInstance.reset(RSIIdleTime::create(backend));
+        m_isIdle = false;
+        connectIdleTime();
+    }
+
+    // Captured notifications can be replayed with rsibreak-sim.
+    const QString capturePath = generalConfig.readEntry("IdleCaptureFile", QString());
+    if (capturePath.isEmpty()) {
+        m_idleCapture.reset();
+    } else if (!m_idleCapture || m_idleCapture->fileName() != capturePath) {
+        m_idleCapture.reset(new RSIIdleTraceWriter(capturePath, m_clock.get()));
+    }
+    if (m_idleCapture) {
+        m_idleCapture->watch(m_idleTimeInstance.get());
+    }
     doRestart = doRestart || (oldUseIdleTimers != m_useIdleTimers);
 
+    // Only with a backend which counts input events.
+    m_useInputIntensity = generalConfig.readEntry("UseInputIntensity", false);
+    if (m_useInputIntensity && !m_idleTimeInstance->countsInput()) {
+        qDebug() << "The idle backend does not count input, input intensity is not metered.";
+        m_useInputIntensity = false;
+    }
+
+    // Only wake up when something visible changes instead of every second.
+    // The input intensity is metered every second.
+    bool oldUseDeadlineScheduler = m_useDeadlineScheduler;
+    m_useDeadlineScheduler = generalConfig.readEntry("UseDeadlineScheduler", true) && !m_useInputIntensity;
+    doRestart = doRestart || (oldUseDeadlineScheduler != m_useDeadlineScheduler);
+
     const QVector<int> oldIntervals = m_intervals;
     m_intervals = RSIGlobals::instance()->intervals();
     doRestart = doRestart || (m_intervals != oldIntervals);
@@ -273,11 +833,21 @@ void RSITimer::updateConfig(bool doRestart)
     if (doRestart) {
         qDebug() << "Timeout parameters have changed, counters were reset.";
         createTimers();
+        registerIdleTimeouts();
+    }
+
+    if (m_tickTimer) {
+        startTickTimer();
     }
 }
 
 // ----------------------------- EVENTS -----------------------//
 
+void RSITimer::onTickTimer()
+{
+    slotReschedule();
+}
+
 void RSITimer::timeout()
 {
     // Don't change the tray icon when suspended, or evaluate a possible break.
@@ -285,125 +855,112 @@ void RSITimer::timeout()
         return;
     }
 
-    const int idleSeconds = idleTime(); // idleSeconds == 0 means activity
+    const qint64 now = m_clock->monotonicMSecs();
+    syncWallClock(now);
+    processTick(now, idleTime(), false);
+}
 
-    RSIGlobals::instance()->stats()->increaseStat(TOTAL_TIME);
-    RSIGlobals::instance()->stats()->setStat(CURRENT_IDLE_TIME, idleSeconds);
-    if (idleSeconds == 0) {
-        RSIGlobals::instance()->stats()->increaseStat(ACTIVITY);
-    } else {
-        RSIGlobals::instance()->stats()->setStat(MAX_IDLENESS, idleSeconds, true);
-    }
+void RSITimer::processTick(const qint64 tickMs, const int idleSeconds, const bool quiet)
+{
+    // idleSeconds == 0 means activity
+    accountTicks(tickMs, 1, idleSeconds, false);
 
     switch (m_state) {
     case TimerState::Monitoring: {
         // This is a weird thing to track as now when user was away, they will get back to zero counters,
         // not to an arbitrary time elapsed since last "idleness-skip-break".
-        bool bigWasReset = m_bigBreakCounter->isReset();
-        bool tinyWasReset = !m_tinyBreakCounter || m_tinyBreakCounter->isReset();
-
-        int breakTime = m_bigBreakCounter->tick(idleSeconds);
-        if (m_tinyBreakCounter) {
-            breakTime = std::max(breakTime, m_tinyBreakCounter->tick(idleSeconds));
+        int longSkips = 0;
+        int shortSkips = 0;
+
+        // The longest break due wins, a long one if they are alike.
+        int breakTime = 0;
+        int breakIndex = -1;
+        for (int i = 0; i < (int)m_breakTiers.size(); ++i) {
+            BreakTier &breakTier = m_breakTiers[i];
+            const bool wasReset = breakTier.counter.isReset();
+            const int tierBreakTime = breakTier.counter.tick(idleSeconds);
+            if (tierBreakTime > breakTime || (tierBreakTime > 0 && tierBreakTime == breakTime && breakTier.isLong)) {
+                breakTime = tierBreakTime;
+                breakIndex = i;
+            } else if (tierBreakTime == 0 && !wasReset && breakTier.counter.isReset()) {
+                ++(breakTier.isLong ? longSkips : shortSkips);
+            }
         }
         if (breakTime > 0) {
-            suggestBreak(breakTime);
+            suggestBreak(breakIndex, breakTime);
         } else {
-            // Not a time for break yet, but if one of the counters got reset, that means we were idle enough to skip.
-            if (!bigWasReset && m_bigBreakCounter->isReset()) {
-                RSIGlobals::instance()->stats()->increaseStat(BIG_BREAKS);
-                RSIGlobals::instance()->stats()->increaseStat(IDLENESS_CAUSED_SKIP_BIG);
-            }
-            if (!tinyWasReset && m_tinyBreakCounter && m_tinyBreakCounter->isReset()) {
-                RSIGlobals::instance()->stats()->increaseStat(TINY_BREAKS);
-                RSIGlobals::instance()->stats()->increaseStat(IDLENESS_CAUSED_SKIP_TINY);
-            }
+            // Not a time for break yet, but maybe idle enough to skip one.
+            countIdleSkips(longSkips, shortSkips);
+        }
+        if (!quiet) {
+            emit updateIdleAvg(idleAvg(tinyLeft(), bigLeft()));
         }
-        const double rawvalue = m_tinyBreakCounter ? m_tinyBreakCounter->counterLeft() / (double)m_intervals[TINY_BREAK_INTERVAL]
-                                                   : m_bigBreakCounter->counterLeft() / (double)m_intervals[BIG_BREAK_INTERVAL];
-        const double value = 100.0 - (rawvalue * 100.0);
-        emit updateIdleAvg(value);
         break;
     }
     case TimerState::Suggesting: {
         // Using popupCounter to count down our patience here.
-        int configuredBreakTime = m_popupCounter->tick(idleSeconds);
+        int configuredBreakTime = m_popupCounter.tick(idleSeconds);
         if (configuredBreakTime > 0) {
             // User kept working through the suggestion timeout. Well, their loss.
-            emit relax(-1, false);
-            int remainingTime = m_pauseCounter->counterLeft();
+            int remainingTime = m_pauseCounter.counterLeft();
             // Ensure at least 50% of configured break time to prevent instant dismissal
             int minimumTime = configuredBreakTime / 2;
             int actualBreakTime = std::max(remainingTime, minimumTime);
-            doBreakNow(actualBreakTime, false);
+            transition(TimerEvent::BreakNow, actualBreakTime);
             break;
         }
 
-        bool isInputLong = (m_shortInputCounter->tick(idleSeconds) > 0);
+        bool isInputLong = (m_shortInputCounter.tick(idleSeconds) > 0);
         int inverseTick = (idleSeconds == 0 && isInputLong) ? 1 : 0; // inverting as we account idle seconds here.
-        int breakTime = m_pauseCounter->tick(inverseTick);
+        int breakTime = m_pauseCounter.tick(inverseTick);
         if (breakTime > 0) {
             // User has waited out the pause, back to monitoring.
-            resetAfterBreak();
+            transition(TimerEvent::BreakOver);
             break;
         }
-        emit relax(m_pauseCounter->counterLeft(), false);
-        emit updateWidget(m_pauseCounter->counterLeft());
+        emit relax(m_pauseCounter.counterLeft(), false);
+        emit updateWidget(m_pauseCounter.counterLeft());
         break;
     }
     case TimerState::Resting: {
-        bool isInputLong = (m_shortInputCounter->tick(idleSeconds) > 0);
+        bool isInputLong = (m_shortInputCounter.tick(idleSeconds) > 0);
         int inverseTick = (idleSeconds == 0 && isInputLong) ? 1 : 0; // inverting as we account idle seconds here.
-        int breakTime = m_pauseCounter->tick(inverseTick);
+        int breakTime = m_pauseCounter.tick(inverseTick);
         if (breakTime > 0) {
-            resetAfterBreak();
+            transition(TimerEvent::BreakOver);
         } else {
-            emit updateWidget(m_pauseCounter->counterLeft());
+            emit updateWidget(m_pauseCounter.counterLeft());
         }
         break;
     }
     default:
         qDebug() << "Reached unexpected state";
     }
-    defaultUpdateToolTip();
+    if (!quiet) {
+        defaultUpdateToolTip();
+        publishSnapshot(idleSeconds);
+    }
 }
 
-void RSITimer::suggestBreak(const int breakTime)
+void RSITimer::suggestBreak(const int breakIndex, const int breakTime)
 {
     if (m_suppressable && suppressionDetector()) {
         return;
     }
 
-    if (m_bigBreakCounter->isReset()) {
+    m_breakIndex = breakIndex;
+    if (isLongBreak()) {
         RSIGlobals::instance()->stats()->increaseStat(BIG_BREAKS);
-        RSIGlobals::instance()->stats()->setStat(LAST_BIG_BREAK, QVariant(QDateTime::currentDateTime()));
+        RSIGlobals::instance()->stats()->setTimestamp(LAST_BIG_BREAK, QDateTime::currentDateTime());
     } else {
         RSIGlobals::instance()->stats()->increaseStat(TINY_BREAKS);
-        RSIGlobals::instance()->stats()->setStat(LAST_TINY_BREAK, QVariant(QDateTime::currentDateTime()));
+        RSIGlobals::instance()->stats()->setTimestamp(LAST_TINY_BREAK, QDateTime::currentDateTime());
     }
 
-    bool nextOneIsBig = !m_tinyBreakCounter || m_bigBreakCounter->counterLeft() <= m_tinyBreakCounter->getDelayTicks();
-    if (!m_usePopup) {
-        doBreakNow(breakTime, nextOneIsBig);
-        return;
-    }
-
-    m_state = TimerState::Suggesting;
-
-    // When pause is longer than patience, we need to reset patience timer so that we don't flip to break now in
-    // mid-pause. Patience / 2 is a good alternative to it by extending patience if user was idle long enough.
-    m_popupCounter = std::unique_ptr<RSITimerCounter>{new RSITimerCounter(m_intervals[PATIENCE_INTERVAL], breakTime, m_intervals[PATIENCE_INTERVAL] / 2)};
-    // Threshold of one means the timer is reset on every non-zero tick.
-    m_pauseCounter = std::unique_ptr<RSITimerCounter>{new RSITimerCounter(breakTime, breakTime, 1)};
-
-    // For measuring input duration in order to limit influence of short inputs on resetting pause counter.
-    // Example of short input is: mouse sent input due to accidental touch or desk vibration.
-    m_shortInputCounter = std::unique_ptr<RSITimerCounter>{new RSITimerCounter(m_intervals[SHORT_INPUT_INTERVAL], 1, 1)};
-
-    emit relax(breakTime, nextOneIsBig);
+    transition(m_usePopup ? TimerEvent::BreakDue : TimerEvent::BreakNow, breakTime);
 }
 
 void RSITimer::defaultUpdateToolTip()
 {
-    emit updateToolTip(m_tinyBreakCounter ? m_tinyBreakCounter->counterLeft() : 0, m_bigBreakCounter->counterLeft());
+    emit updateToolTip(tinyLeft(), bigLeft());
 }
@@ -11,11 +11,20 @@
 #define RSITimer_H
 
 #include <QDateTime>
+#include <QRgb>
 #include <QVector>
 #include <memory>
+#include <tuple>
+#include <vector>
 
+#include "rsiclock.h"
 #include "rsiidletime.h"
+#include "rsiidletrace.h"
+#include "rsisuppressionmonitor.h"
 #include "rsitimercounter.h"
+#include "rsitimersnapshot.h"
+
+class QTimer;
 
 /**
  * @class RSITimer
@@ -27,6 +36,8 @@ class RSITimer : public QObject
 {
     Q_OBJECT
     friend class RSITimerTest;
+    friend class RSISimulator;
+    friend class RSIBenchmark;
 
 public:
     /**
@@ -44,14 +55,36 @@ public:
 
     int tinyLeft() const
     {
-        return m_tinyBreakCounter ? m_tinyBreakCounter->counterLeft() : 0;
+        const RSITimerCounter *counter = tierCounter(TINY_TIER);
+        return counter ? counter->counterLeft() : 0;
     };
 
     int bigLeft() const
     {
-        return m_bigBreakCounter->counterLeft();
+        return tierCounter(BIG_TIER)->counterLeft();
     };
 
+    /**
+      Applies all seconds that passed on the monotonic clock since the last
+      evaluation in one go, and resets the counters after a suspend.
+      In deadline scheduling mode the timer only wakes up when something
+      visible is about to change, so call this before reading the counters
+      from outside.
+    */
+    void catchUp();
+
+    // The idle backend in use, for its name and latency.
+    const RSIIdleTime &idleTimeBackend() const
+    {
+        return *m_idleTimeInstance;
+    }
+
+    // @returns the last snapshot sent with snapshotChanged().
+    const RSITimerSnapshot &snapshot() const
+    {
+        return m_snapshot;
+    }
+
 public slots:
 
     /**
@@ -95,11 +128,32 @@ public slots:
     void postponeBreak();
 
     /**
-      Queries X how many seconds the user has been idle. A value of 0
-      means there was activity during the last second.
+      How many seconds the user has been idle, as reported by the idle
+      backend. A value of 0 means there was activity during the last second.
+      Only reads the idle state, so it is safe to call from anywhere.
       @returns The amount of seconds of idling.
     */
-    int idleTime();
+    int idleTime() const;
+
+    /**
+      Seconds left till the next tiny or big break, as of now. For callers
+      outside the timer like D-Bus: unlike catchUp() followed by tinyLeft(),
+      this leaves the timer alone, neither ticking nor checking for suspend.
+    */
+    int tinyLeftNow() const
+    {
+        return tierLeftAt(TINY_TIER, m_clock->monotonicMSecs());
+    }
+    int bigLeftNow() const
+    {
+        return tierLeftAt(BIG_TIER, m_clock->monotonicMSecs());
+    }
+
+    /**
+      Catches up and plans the next wakeup again. Used when something outside
+      the timer needs per second updates, e.g. the statistics became visible.
+    */
+    void slotReschedule();
 
 private slots:
     /**
@@ -108,6 +162,12 @@ private slots:
     */
     virtual void timeout();
 
+    /**
+      Called when the tick timer fires, either every second or at the
+      planned deadline. Catches up on the elapsed time.
+    */
+    void onTickTimer();
+
     /**
      * Called when an idle timeout is reached.
      * @param msec The timeout duration that was reached
@@ -123,6 +183,14 @@ signals:
     /** Enforce a fullscreen big break. */
     void breakNow();
 
+    /**
+      Everything the tooltip, tray icon, break widget and relax popup show,
+      at most once per tick and only when some of it changed. Connect to
+      this one rather than to updateToolTip(), updateWidget(),
+      updateIdleAvg() and relax(), which are emitted every tick.
+    */
+    void snapshotChanged(const RSITimerSnapshot &snapshot);
+
     /**
       Update counters in tooltip.
       @param tinyLeft If <=0 a tiny break is active, else it defines how
@@ -178,15 +246,41 @@ signals:
 
 private:
     std::unique_ptr<RSIIdleTime> m_idleTimeInstance;
+    std::unique_ptr<RSIClock> m_clock;
+
+    // Only there while capturing the idle notifications, see RSIIdleTrace.
+    std::unique_ptr<RSIIdleTraceWriter> m_idleCapture;
+
+    // Only there while breaks are suppressed when presenting.
+    std::unique_ptr<RSISuppressionMonitor> m_suppressionMonitor;
 
-    bool m_suppressable;
+    bool m_suppressable = false;
     bool m_usePopup;
     bool m_useIdleTimers;
+    bool m_useDeadlineScheduler = false;
+    // Counters advance by input intensity, see meterInputIntensity().
+    bool m_useInputIntensity = false;
+    // Load not applied to the counters yet, in thousandths of a tick.
+    qint64 m_intensityCarry = 0;
     QVector<int> m_intervals;
 
+    // Drives the timer, see startTickTimer().
+    QTimer *m_tickTimer = nullptr;
+
+    // Monotonic time of the last evaluated tick.
+    qint64 m_lastTickMs = 0;
+    // Wall clock minus monotonic time, for the activity log, see syncWallClock().
+    qint64 m_wallOffsetMs = 0;
+
+    // Both clocks at the last suspend check, see suspendDetector().
+    qint64 m_lastCheckMonotonicMs = 0;
+    qint64 m_lastCheckBoottimeMs = 0;
+
     // Idle state tracking (for event-based idle detection)
     bool m_isIdle = false;
-    QDateTime m_idleStartTime;
+    qint64 m_idleStartMs = 0; // monotonic
+    // If the threshold timeouts will fire for the current idle period.
+    bool m_idleTimeoutsArmed = false;
 
     enum class TimerState {
         Suspended = 0, // user has suspended either via dbus or tray.
@@ -195,25 +289,177 @@ private:
         Resting // suggestion ignored, waiting out the break.
     } m_state;
 
-    std::unique_ptr<RSITimerCounter> m_bigBreakCounter;
-    std::unique_ptr<RSITimerCounter> m_tinyBreakCounter;
-    std::unique_ptr<RSITimerCounter> m_pauseCounter;
-    std::unique_ptr<RSITimerCounter> m_popupCounter;
-    std::unique_ptr<RSITimerCounter> m_shortInputCounter;
+    // The tiers of RSIGlobals::tierCount(), with the ones turned off left out.
+    enum { TINY_TIER = 0, BIG_TIER = 1 };
+    struct BreakTier {
+        int tier;
+        RSITimerCounter counter;
+        bool isLong; // counts as a big break
+    };
+    std::vector<BreakTier> m_breakTiers;
+
+    // Scratch copy of m_breakTiers for ticksToNextDeadline(), sized with it.
+    std::vector<BreakTier> m_plannedTiers;
+
+    // Index in m_breakTiers of the break in progress, or -1.
+    int m_breakIndex = -1;
+
+    // If the break suggested is followed by a big one.
+    bool m_nextBreakIsBig = false;
+
+    // The last snapshot sent with snapshotChanged().
+    RSITimerSnapshot m_snapshot;
+
+    // Counters of the break in progress. They are only meaningful while
+    // Suggesting (all three) or Resting (pause and short input), and are
+    // reassigned in place, so that breaks do not allocate.
+    RSITimerCounter m_pauseCounter{0, 0, 0};
+    RSITimerCounter m_popupCounter{0, 0, 0};
+    RSITimerCounter m_shortInputCounter{0, 0, 0};
+
+    enum class TimerEvent {
+        BreakDue, // a break is due and is suggested first
+        BreakNow, // a break is due and starts right away
+        BreakOver, // the break passed, was skipped, postponed or the screen locked
+        Start,
+        Stop
+    };
+
+    /**
+      Moves the state machine on @p event, by the transitions table in
+      transition(), and runs the action of the state entered.
+      @param breakTime The seconds to break for, for BreakDue and BreakNow.
+    */
+    void transition(const TimerEvent event, const int breakTime = 0);
+
+    // Actions of the transitions, @p breakTime as given to transition().
+    void startSuggesting(const int breakTime);
+    void startResting(const int breakTime);
+    void startRestingAfterPatience(const int breakTime);
+    void finishBreak(const int breakTime);
+    void stopped(const int breakTime);
 
+    // @returns true if the next break is a big one.
+    bool nextBreakIsBig() const;
+
+    // @returns true if breaks are suppressed, e.g. by a fullscreen window.
     bool suppressionDetector();
-    void hibernationDetector(const int totalIdle);
-    void suggestBreak(const int time);
+    // @returns true if the computer was suspended since the last call.
+    bool suspendDetector();
+    void suggestBreak(const int breakIndex, const int breakTime);
+
+    // @returns the counter of break tier @p tier, nullptr if it is turned off.
+    const RSITimerCounter *tierCounter(const int tier) const;
+    RSITimerCounter *tierCounter(const int tier);
+
+    // @returns the ticks left of @p tier with the seconds up to @p clockMs
+    // applied to a copy of its counter, the way catchUp() would. A break
+    // due by then leaves 0.
+    int tierLeftAt(const int tier, const qint64 clockMs) const;
+
+    // @returns if the break in progress, or else the last one, is a big break.
+    bool isLongBreak() const;
     void defaultUpdateToolTip();
     void createTimers();
+
+    /**
+      Registers idle timeouts at one second, to notice idleness, and at the
+      reset threshold of every break. The counters are reset from
+      onIdleTimeoutReached(), not by sampling. Breaks tick every second
+      anyway, and the idle time includes the idling before a break, so the
+      end of a break is left to the pause counter.
+    */
     void registerIdleTimeouts();
 
-    // This function is called when a break has passed.
-    void resetAfterBreak();
+    // @returns seconds the user has been idle at monotonic time @p clockMs.
+    int idleSecondsAt(qint64 clockMs) const;
+
+    /**
+      Evaluates one second of user activity, the one ending at monotonic
+      time @p tickMs.
+      @param idleSeconds Seconds the user has been idle, 0 means activity.
+      @param quiet If true, skip the per second tooltip and icon updates
+      because another tick follows right away.
+    */
+    void processTick(const qint64 tickMs, const int idleSeconds, const bool quiet);
+
+    /**
+      Evaluates @p ticks seconds at once, the first one at monotonic time
+      @p firstTickMs. Stretches without a state change are applied in bulk.
+    */
+    void advanceTicks(qint64 firstTickMs, int ticks);
+
+    /**
+      @returns how many ticks from now on can be applied with applyTicks()
+      without the state changing, with the current idle state and
+      @p idleSeconds idle at the first of them.
+    */
+    int ticksWithoutTransition(const int idleSeconds) const;
+
+    // Applies @p ticks ticks from @p firstTickMs on within the current state, see ticksWithoutTransition().
+    void applyTicks(const qint64 firstTickMs, const int ticks, const int idleSeconds);
+
+    /**
+      Records @p ticks seconds in the statistics, the last one ending at
+      monotonic time @p lastTickMs.
+      @param idleSeconds Seconds idle at the first tick, 0 means activity.
+      @param idleGrows If true, every following tick is a second more idle,
+      otherwise all ticks are like the first one.
+    */
+    void accountTicks(const qint64 lastTickMs, const int ticks, const int idleSeconds, const bool idleGrows);
+
+    // Takes the wall clock offset of monotonic time @p clockMs, if it jumped.
+    void syncWallClock(const qint64 clockMs);
+
+    // Records breaks skipped by idling, by the number of tiers reset.
+    void countIdleSkips(const int longSkips, const int shortSkips);
+
+    // @returns how full the tray icon is, from 0 to 100.
+    double idleAvg(const int tinyLeft, const int bigLeft) const;
+
+    // @returns what the tooltip and tray icon show: tooltip text and
+    // colours for both breaks, and the icon level.
+    std::tuple<int, int, QRgb, QRgb, int> trayView(const int tinyLeft, const int bigLeft) const;
+
+    /**
+      Emits snapshotChanged() if anything visible changed since the last one.
+      @param idleSeconds Seconds idle at the tick, passed along as is.
+    */
+    void publishSnapshot(const int idleSeconds);
+
+    /**
+      Works out how many ticks from now something visible happens: a break,
+      an idle reset or a change in the tooltip or tray icon. Nothing else can
+      change while the idle state stays the same.
+      @returns the number of ticks, or 0 when nothing will change until the
+      idle state changes. Not const, as it plays the counters forward in
+      m_plannedTiers.
+    */
+    int ticksToNextDeadline();
+
+    /**
+      Weighs the active seconds of the last @p ticks ticks by the input
+      events the backend counted. Busy seconds count up to twice towards
+      the next break, quiet ones as little as half. Idle seconds and breaks
+      are left as they are.
+    */
+    void meterInputIntensity(const int ticks);
+
+    // Arms the tick timer for the next deadline in deadline scheduling mode.
+    void scheduleNextDeadline();
+
+    // (Re)starts the tick timer in the configured scheduling mode.
+    void startTickTimer();
 
     // Start this timer. Used by the constructors.
     void run();
 
+    // @returns the idle backend configured, a known one.
+    static QString idleBackend();
+
+    // Connects to the idle backend and registers the idle timeouts.
+    void connectIdleTime();
+
     /**
       Some internal preparations for a fullscreen break window.
       @param breakTime The amount of seconds to break.
@@ -222,7 +468,11 @@ private:
     void doBreakNow(const int breakTime, const bool nextBreakIsBig);
 
     // Constructor for tests.
-    RSITimer(std::unique_ptr<RSIIdleTime> &&_idleTime, const QVector<int> _intervals, const bool _usePopup, const bool _useIdleTimers);
+    RSITimer(std::unique_ptr<RSIIdleTime> &&_idleTime,
+             const QVector<int> _intervals,
+             const bool _usePopup,
+             const bool _useIdleTimers,
+             std::unique_ptr<RSIClock> &&_clock = nullptr);
 };
 
 #endif
@@ -5,6 +5,7 @@
 #include "rsitimercounter.h"
 
 #include <algorithm>
+#include <climits>
 
 int RSITimerCounter::tick(const int idleTime)
 {
@@ -26,7 +27,71 @@ int RSITimerCounter::tick(const int idleTime)
     return 0;
 }
 
-bool RSITimerCounter::isReset()
+long long RSITimerCounter::ticksToReset(const int idleTime, const bool idleGrows) const
+{
+    if (idleTime >= m_resetThreshold) {
+        return 0;
+    }
+    return idleGrows ? (long long)m_resetThreshold - idleTime : LLONG_MAX;
+}
+
+int RSITimerCounter::ticksToBreak(const int idleTime, const bool idleGrows) const
+{
+    // The break check comes first in tick(), so it wins on the tick the
+    // reset would happen as well.
+    const long long breakAt = std::max(0, m_delayTicks - m_counter - 1);
+    if (breakAt <= ticksToReset(idleTime, idleGrows)) {
+        return breakAt + 1;
+    }
+    return INT_MAX;
+}
+
+int RSITimerCounter::advance(const int ticks, const int idleTime, const bool idleGrows)
+{
+    // Every single tick is a break.
+    if (m_delayTicks <= 1) {
+        if (ticks > 0) {
+            reset();
+        }
+        return std::max(ticks, 0);
+    }
+
+    int breaks = 0;
+    int done = 0;
+    while (done < ticks) {
+        const int left = ticks - done;
+        const int idle = idleGrows ? idleTime + done : idleTime;
+        const long long resetAt = ticksToReset(idle, idleGrows);
+
+        const int toBreak = ticksToBreak(idle, idleGrows);
+        if (toBreak > left) {
+            // No more breaks, and once idle for long enough it stays reset.
+            if (resetAt < left) {
+                reset();
+            } else {
+                m_counter += left;
+            }
+            return breaks;
+        }
+
+        if (m_counter == 0) {
+            // Freshly reset, a break every m_delayTicks until the idle reset.
+            const long long cycles = std::min<long long>(left / m_delayTicks, resetAt == LLONG_MAX ? LLONG_MAX : (resetAt + 1) / m_delayTicks);
+            if (cycles > 0) {
+                breaks += cycles;
+                done += cycles * m_delayTicks;
+                continue;
+            }
+        }
+
+        done += toBreak;
+        reset();
+        ++breaks;
+    }
+    return breaks;
+}
+
+bool RSITimerCounter::isReset() const
 {
     return m_counter == 0;
 }
@@ -41,6 +106,14 @@ void RSITimerCounter::postpone(int ticks)
     m_counter = std::max(0, m_delayTicks - ticks);
 }
 
+void RSITimerCounter::addLoad(const int ticks)
+{
+    if (m_counter == 0) {
+        return;
+    }
+    m_counter = std::clamp(m_counter + ticks, 1, std::max(1, m_delayTicks - 1));
+}
+
 int RSITimerCounter::counterLeft() const
 {
     return m_delayTicks - m_counter;
@@ -50,3 +123,8 @@ int RSITimerCounter::getDelayTicks() const
 {
     return m_delayTicks;
 }
+
+int RSITimerCounter::getResetThreshold() const
+{
+    return m_resetThreshold;
+}
@@ -8,9 +8,10 @@
 class RSITimerCounter
 {
 private:
-    const int m_delayTicks;
-    const int m_breakLength;
-    const int m_resetThreshold;
+    // Not const, so that counters can be reused by assigning new ones.
+    int m_delayTicks;
+    int m_breakLength;
+    int m_resetThreshold;
 
     int m_counter; // counts ticks of user activity.
 
@@ -32,6 +33,22 @@ public:
     // @returns non zero if break is due, for the number of ticks to break for.
     int tick(const int idleTime);
 
+    // Counts `ticks` ticks in one step, in constant time. The outcome is the
+    // same as calling tick() `ticks` times, with `idleTime` for the first
+    // tick and one second more for each following one if `idleGrows`, or the
+    // same idle time for all of them otherwise (e.g. 0 for activity).
+    // @returns the number of breaks that became due.
+    int advance(const int ticks, const int idleTime, const bool idleGrows);
+
+    // @returns the number of ticks until a break is due, counting the tick
+    // it is due on, for idle times as described in advance(). INT_MAX if no
+    // break will become due.
+    int ticksToBreak(const int idleTime, const bool idleGrows) const;
+
+    // @returns the index of the first tick idle for long enough to reset,
+    // for idle times as described in advance(). LLONG_MAX if never.
+    long long ticksToReset(const int idleTime, const bool idleGrows) const;
+
     // Resets the counter.
     void reset();
 
@@ -41,11 +58,19 @@ public:
     // @returns ticks this timer delays for.
     int getDelayTicks() const;
 
+    // @returns seconds of idleness which reset this timer.
+    int getResetThreshold() const;
+
     // @param ticks Postpones the timer by `ticks` ticks.
     void postpone(int ticks);
 
+    // Counts `ticks` ticks of extra load, or takes them back if negative.
+    // This neither makes a break due nor resets the counter, both are left
+    // to tick().
+    void addLoad(const int ticks);
+
     // Returns if the timer was just reset.
-    bool isReset();
+    bool isReset() const;
 };
 
 #endif // RSIBREAK_RSITIMERCOUNTER_H
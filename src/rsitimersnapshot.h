@@ -0,0 +1,29 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSITIMERSNAPSHOT_H
+#define RSIBREAK_RSITIMERSNAPSHOT_H
+
+#include <QMetaType>
+
+/**
+ * What RSITimer shows the user as of its last tick. It is sent whenever
+ * something visible changed, and the receivers compare it with the one
+ * they got before to only update what changed.
+ */
+struct RSITimerSnapshot {
+    int state = 1; // an RSITimer::TimerState, Monitoring by default
+    int tinyLeft = 0; // seconds until the next tiny break, 0 if there is none
+    int bigLeft = 0; // seconds until the next big break
+    int breakLeft = 0; // seconds left of the break suggested or in progress, 0 without one
+    int relaxLeft = -1; // seconds the relax popup asks for, -1 when it is hidden
+    int patienceLeft = 0; // seconds until a suggested break is enforced
+    bool nextBreakIsBig = false; // the break suggested is followed by a big one
+    int idleSeconds = 0; // not shown, so changes alone are not sent
+    int iconLevel = 0; // progress to the next break, as a tray icon level
+};
+
+Q_DECLARE_METATYPE(RSITimerSnapshot)
+
+#endif // RSIBREAK_RSITIMERSNAPSHOT_H
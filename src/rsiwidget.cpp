@@ -10,9 +10,13 @@
 #include "grayeffect.h"
 #include "plasmaeffect.h"
 #include "popupeffect.h"
+#include "rsiactivitylog.h"
 #include "rsidock.h"
 #include "rsiglobals.h"
+#include "rsihistory.h"
+#include "rsiidletime.h"
 #include "rsirelaxpopup.h"
+#include "rsistats.h"
 #include "rsitimer.h"
 #include "rsiwidgetadaptor.h"
 #include "slideshoweffect.h"
@@ -29,10 +33,12 @@
 #include <QDBusInterface>
 #include <QTemporaryFile>
 
-#include <KFormat>
 #include <math.h>
 #include <time.h>
 
+// Milliseconds between StatsChanged signals, at most.
+static constexpr int STATS_CHANGED_INTERVAL = 1000;
+
 RSIObject::RSIObject(QWidget *parent)
     : QObject(parent)
     , m_timer(nullptr)
@@ -52,6 +58,12 @@ RSIObject::RSIObject(QWidget *parent)
     m_relaxpopup = new RSIRelaxPopup(nullptr);
     connect(m_relaxpopup, &RSIRelaxPopup::lock, this, &RSIObject::slotLock);
 
+    m_activityLog = new RSIActivityLog(RSIActivityLog::defaultDirectory());
+    m_activityLog->flushOnCrash();
+    // This object is never destroyed, so its destructor cannot flush.
+    m_activityLog->flushOnQuit();
+    RSIGlobals::instance()->stats()->setActivityLog(m_activityLog);
+
     connect(m_tray, &RSIDock::configChanged, RSIGlobals::instance(), &RSIGlobals::slotReadConfig);
     connect(m_tray, &RSIDock::configChanged, this, &RSIObject::readConfig);
     connect(m_tray, &RSIDock::configChanged, m_relaxpopup, &RSIRelaxPopup::slotReadConfig);
@@ -61,6 +73,11 @@ RSIObject::RSIObject(QWidget *parent)
 
     setIcon(0);
 
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setSingleShot(true);
+    m_statsTimer->setInterval(STATS_CHANGED_INTERVAL);
+    connect(m_statsTimer, &QTimer::timeout, this, &RSIObject::publishStats);
+
     QTimer::singleShot(2000, this, &RSIObject::slotWelcome);
 }
 
@@ -69,6 +86,7 @@ RSIObject::~RSIObject()
     delete m_effect;
     delete RSIGlobals::instance();
     delete m_timer;
+    delete m_activityLog;
 }
 
 void RSIObject::slotWelcome()
@@ -108,7 +126,7 @@ void RSIObject::slotLock()
 void RSIObject::setCounters(int timeleft)
 {
     if (timeleft > 0) {
-        m_effect->setLabel(KFormat().formatSpelloutDuration(timeleft * 1000));
+        m_effect->setLabel(RSIGlobals::instance()->formatSeconds(timeleft));
     } else if (m_timer->isSuspended()) {
         m_effect->setLabel(i18n("Suspended"));
     } else {
@@ -116,18 +134,37 @@ void RSIObject::setCounters(int timeleft)
     }
 }
 
-void RSIObject::updateIdleAvg(double idleAvg)
+void RSIObject::applySnapshot(const RSITimerSnapshot &snapshot)
+{
+    if (snapshot.breakLeft != m_snapshot.breakLeft || snapshot.state != m_snapshot.state) {
+        setCounters(snapshot.breakLeft);
+    }
+    if (snapshot.iconLevel != m_snapshot.iconLevel || snapshot.state != m_snapshot.state) {
+        setIcon(snapshot.iconLevel);
+    }
+    m_tray->setSnapshot(snapshot);
+    m_relaxpopup->setSnapshot(snapshot);
+    m_snapshot = snapshot;
+
+    if (!m_statsTimer->isActive()) {
+        m_statsTimer->start();
+    }
+}
+
+void RSIObject::publishStats()
 {
-    if (idleAvg == 0.0)
-        setIcon(0);
-    else if (idleAvg > 0 && idleAvg < 30)
-        setIcon(1);
-    else if (idleAvg >= 30 && idleAvg < 60)
-        setIcon(2);
-    else if (idleAvg >= 60 && idleAvg < 90)
-        setIcon(3);
-    else
-        setIcon(4);
+    const QVariantMap current = stats();
+    QVariantMap changed;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (m_publishedStats.value(it.key()) != it.value()) {
+            changed.insert(it.key(), it.value());
+        }
+    }
+    m_publishedStats = current;
+
+    if (!changed.isEmpty()) {
+        emit StatsChanged(changed);
+    }
 }
 
 void RSIObject::setIcon(int level)
@@ -164,11 +201,9 @@ void RSIObject::configureTimer()
     m_timer = new RSITimer(this);
 
     connect(m_timer, &RSITimer::breakNow, this, &RSIObject::maximize, Qt::QueuedConnection);
-    connect(m_timer, &RSITimer::updateWidget, this, &RSIObject::setCounters, Qt::QueuedConnection);
-    connect(m_timer, &RSITimer::updateToolTip, m_tray, &RSIDock::setCounters, Qt::QueuedConnection);
-    connect(m_timer, &RSITimer::updateIdleAvg, this, &RSIObject::updateIdleAvg, Qt::QueuedConnection);
+    // One queued event per visible change, instead of one per counter every second.
+    connect(m_timer, &RSITimer::snapshotChanged, this, &RSIObject::applySnapshot, Qt::QueuedConnection);
     connect(m_timer, &RSITimer::minimize, this, &RSIObject::minimize, Qt::QueuedConnection);
-    connect(m_timer, &RSITimer::relax, m_relaxpopup, &RSIRelaxPopup::relax, Qt::QueuedConnection);
     connect(m_timer, &RSITimer::tinyBreakSkipped, this, &RSIObject::tinyBreakSkipped, Qt::QueuedConnection);
     connect(m_timer, &RSITimer::bigBreakSkipped, this, &RSIObject::bigBreakSkipped, Qt::QueuedConnection);
     connect(m_timer, &RSITimer::startLongBreak, &m_notificator, &Notificator::onStartLongBreak);
@@ -179,6 +214,7 @@ void RSIObject::configureTimer()
     connect(m_tray, &RSIDock::dialogEntered, m_timer, &RSITimer::slotStop);
     connect(m_tray, &RSIDock::dialogLeft, m_timer, &RSITimer::slotStart);
     connect(m_tray, &RSIDock::suspend, m_timer, &RSITimer::slotSuspended);
+    connect(m_tray, &RSIDock::statisticsShown, m_timer, &RSITimer::slotReschedule);
 
     connect(m_relaxpopup, &RSIRelaxPopup::skip, m_timer, &RSITimer::skipBreak);
     connect(m_relaxpopup, &RSIRelaxPopup::postpone, m_timer, &RSITimer::postponeBreak);
@@ -256,3 +292,66 @@ void RSIObject::suspend()
 {
     m_tray->doSuspend();
 }
+
+QVariantMap RSIObject::history(const QString &grouping, int days)
+{
+    static const QMap<QString, RSIHistory::Grouping> groupings = {
+        {QStringLiteral("day"), RSIHistory::Grouping::Day},
+        {QStringLiteral("week"), RSIHistory::Grouping::Week},
+        {QStringLiteral("hour"), RSIHistory::Grouping::HourOfDay},
+    };
+
+    QVariantMap result;
+    RSIHistory *history = RSIGlobals::instance()->stats()->history();
+    if (!history || days <= 0 || !groupings.contains(grouping)) {
+        return result;
+    }
+
+    const QDate today = QDate::currentDate();
+    const QVector<RSIHistory::Aggregate> rows = history->query(today.addDays(1 - days), today, groupings.value(grouping));
+
+    QStringList start;
+    QList<int> hour, breaksTaken, breaksSkipped, breaksPostponed, longestStretch;
+    QList<qlonglong> activeSeconds;
+    for (const RSIHistory::Aggregate &row : rows) {
+        start << row.start.toString(Qt::ISODate);
+        hour << row.hour;
+        activeSeconds << row.counts.activeSeconds;
+        breaksTaken << row.counts.breaksTaken;
+        breaksSkipped << row.counts.breaksSkipped;
+        breaksPostponed << row.counts.breaksPostponed;
+        longestStretch << row.longestStretch;
+    }
+
+    result[QStringLiteral("start")] = start;
+    result[QStringLiteral("hour")] = QVariant::fromValue(hour);
+    result[QStringLiteral("activeSeconds")] = QVariant::fromValue(activeSeconds);
+    result[QStringLiteral("breaksTaken")] = QVariant::fromValue(breaksTaken);
+    result[QStringLiteral("breaksSkipped")] = QVariant::fromValue(breaksSkipped);
+    result[QStringLiteral("breaksPostponed")] = QVariant::fromValue(breaksPostponed);
+    result[QStringLiteral("longestStretch")] = QVariant::fromValue(longestStretch);
+    return result;
+}
+
+QVariantMap RSIObject::stats()
+{
+    QVariantMap map = RSIGlobals::instance()->stats()->toVariantMap();
+    map.insert(QStringLiteral("idleTime"), m_snapshot.idleSeconds);
+    map.insert(QStringLiteral("tinyLeft"), m_snapshot.tinyLeft);
+    map.insert(QStringLiteral("bigLeft"), m_snapshot.bigLeft);
+    map.insert(QStringLiteral("currentIcon"), m_currentIcon);
+    return map;
+}
+
+QVariantMap RSIObject::idleBackend()
+{
+    const RSIIdleTime &backend = timer()->idleTimeBackend();
+    const RSIIdleTime::Latency &latency = backend.latency();
+    QVariantMap map;
+    map.insert(QStringLiteral("name"), backend.objectName());
+    map.insert(QStringLiteral("backends"), RSIIdleTime::backends());
+    map.insert(QStringLiteral("latencyCount"), latency.count);
+    map.insert(QStringLiteral("latencyAverageMs"), latency.averageMs());
+    map.insert(QStringLiteral("latencyMaxMs"), latency.maxMs);
+    return map;
+}
@@ -12,6 +12,8 @@
 #include "notificator.h"
 #include "rsitimer.h"
 
+class QTimer;
+class RSIActivityLog;
 class RSIDock;
 class RSIRelaxPopup;
 class BreakBase;
@@ -60,11 +62,14 @@ private slots:
     void minimize();
     void maximize();
     void setCounters(int);
-    void updateIdleAvg(double);
+    void applySnapshot(const RSITimerSnapshot &snapshot);
     void readConfig();
     void tinyBreakSkipped();
     void bigBreakSkipped();
 
+    // Emits StatsChanged with what changed since the last time.
+    void publishStats();
+
 protected:
     /** Sets appropriate icon in tooltip and docker. */
     void setIcon(int);
@@ -85,11 +90,29 @@ private:
 
     RSIRelaxPopup *m_relaxpopup;
 
+    // Keeps the activity of past days, fed by the statistics.
+    RSIActivityLog *m_activityLog;
+
     QString m_currentIcon;
 
+    // The last snapshot of the timer, to tell what changed.
+    RSITimerSnapshot m_snapshot;
+
+    // Keeps StatsChanged to one per STATS_CHANGED_INTERVAL.
+    QTimer *m_statsTimer;
+    // The stats as last sent with StatsChanged.
+    QVariantMap m_publishedStats;
+
     Notificator m_notificator;
 
     /* Available through D-Bus */
+Q_SIGNALS:
+    /**
+     * The keys of stats() which changed, with their new values. Sent at most
+     * once a second, instead of polling stats().
+     */
+    void StatsChanged(const QVariantMap &changed);
+
 public Q_SLOTS:
     void resume();
     void suspend();
@@ -99,16 +122,38 @@ public Q_SLOTS:
     }
     int tinyLeft()
     {
-        return timer()->tinyLeft();
+        return timer()->tinyLeftNow();
     }
     int bigLeft()
     {
-        return timer()->bigLeft();
+        return timer()->bigLeftNow();
     }
     QString currentIcon()
     {
         return m_currentIcon;
     }
+
+    /**
+     * The logged history of the last @p days days, up to today, grouped by
+     * "day", "week" or "hour" of the day. One list per column: start,
+     * hour, activeSeconds, breaksTaken, breaksSkipped, breaksPostponed
+     * and longestStretch. Empty without an activity log.
+     */
+    QVariantMap history(const QString &grouping, int days);
+
+    /**
+     * All statistics, by RSIStats::key(), along with idleTime, tinyLeft,
+     * bigLeft and currentIcon as of the last tick of the timer, which can
+     * be a while ago in deadline scheduling mode.
+     */
+    QVariantMap stats();
+
+    /**
+     * The idle backend in use as name, all available ones as backends, and
+     * how late it reported idle timeouts so far: latencyCount,
+     * latencyAverageMs and latencyMaxMs.
+     */
+    QVariantMap idleBackend();
 };
 
 #endif
@@ -0,0 +1,45 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "allocationcounter.h"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local bool s_counting = false;
+static thread_local int s_allocations = 0;
+
+void AllocationCounter::start()
+{
+    s_allocations = 0;
+    s_counting = true;
+}
+
+int AllocationCounter::stop()
+{
+    s_counting = false;
+    return s_allocations;
+}
+
+// The other forms of new and delete end up in these ones.
+void *operator new(std::size_t size)
+{
+    if (s_counting) {
+        ++s_allocations;
+    }
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
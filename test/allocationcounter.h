@@ -0,0 +1,22 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_ALLOCATIONCOUNTER_H
+#define RSIBREAK_ALLOCATIONCOUNTER_H
+
+/**
+ * Counts heap allocations made through operator new, which the test binary
+ * replaces. Only allocations of the thread that started counting are
+ * counted, so other Qt threads do not disturb the result.
+ */
+namespace AllocationCounter
+{
+// Starts counting from zero on the calling thread.
+void start();
+
+// Stops counting. @returns the number of allocations since start().
+int stop();
+}
+
+#endif // RSIBREAK_ALLOCATIONCOUNTER_H
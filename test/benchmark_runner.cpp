@@ -0,0 +1,40 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QApplication>
+#include <QTest>
+
+#include <algorithm>
+
+#include "rsibenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    // Nothing is ever shown, so it runs on build machines as well.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    // Results are written as CSV unless another output format is asked for,
+    // e.g. "-o results.xml,xml", so they can be compared between releases.
+    QStringList args = app.arguments();
+    static const QStringList formatOptions = {QStringLiteral("-o"),
+                                              QStringLiteral("-txt"),
+                                              QStringLiteral("-csv"),
+                                              QStringLiteral("-xml"),
+                                              QStringLiteral("-lightxml"),
+                                              QStringLiteral("-junitxml"),
+                                              QStringLiteral("-teamcity"),
+                                              QStringLiteral("-tap")};
+    const bool hasFormat = std::any_of(args.cbegin(), args.cend(), [](const QString &arg) {
+        return formatOptions.contains(arg);
+    });
+    if (!hasFormat) {
+        args << QStringLiteral("-csv");
+    }
+
+    RSIBenchmark benchmark;
+    return QTest::qExec(&benchmark, args);
+}
@@ -0,0 +1,133 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiactivityheatmap_test.h"
+
+#include "rsiactivityheatmap.h"
+#include "rsiactivityhistory.h"
+
+#include <QRandomGenerator>
+#include <memory>
+
+// A Tuesday, away from the clocks changing.
+static const QDate TUESDAY(2024, 3, 5);
+
+// Sets the wall clock of @p heatmap to @p time, and places the cells again.
+static void setCurrentDateTime(RSIActivityHeatmap &heatmap, const QDateTime &time)
+{
+    heatmap.m_currentDateTime = [time]() {
+        return time;
+    };
+    heatmap.setPeriod(heatmap.period());
+}
+
+void RSIActivityHeatmapTest::cells()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+    RSIActivityHeatmap heatmap(*history);
+    const QRgb idle = heatmap.palette().color(QPalette::Base).rgb();
+    const QRgb active = heatmap.palette().color(QPalette::Highlight).rgb();
+
+    // Half an hour of work, half an hour idle and half a minute of work,
+    // from 9:00 to now.
+    history->record(true, 30 * 60);
+    history->record(false, 30 * 60);
+    history->record(true, 30);
+    setCurrentDateTime(heatmap, QDateTime(TUESDAY, QTime(10, 0, 30)));
+
+    const QImage &image = heatmap.image();
+    QCOMPARE(image.size(), QSize(60, 24));
+    QCOMPARE(image.pixel(0, 22), active);
+    QCOMPARE(image.pixel(29, 22), active);
+    QCOMPARE(image.pixel(30, 22), idle);
+    QCOMPARE(image.pixel(59, 22), idle);
+    // The current minute is half done.
+    QVERIFY(image.pixel(0, 23) != idle && image.pixel(0, 23) != active);
+    // Not recorded yet.
+    QCOMPARE(image.pixel(1, 23), QRgb(0));
+    QCOMPARE(image.pixel(0, 21), QRgb(0));
+    QCOMPARE(heatmap.rowLabel(heatmap.m_row), QLocale().toString(QTime(10, 0), QLocale::ShortFormat));
+}
+
+void RSIActivityHeatmapTest::wallClock()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+    RSIActivityHeatmap heatmap(*history);
+    const QRgb active = heatmap.palette().color(QPalette::Highlight).rgb();
+
+    // Two minutes of work up to 9:31:30, the cells are the minutes of the
+    // clock, not of the recording.
+    history->record(true, 120);
+    setCurrentDateTime(heatmap, QDateTime(TUESDAY, QTime(9, 31, 30)));
+
+    const QImage &image = heatmap.image();
+    QCOMPARE(image.pixel(28, 23), QRgb(0));
+    // Half of 9:29 and all of 9:30 and half of 9:31.
+    QVERIFY(image.pixel(29, 23) != active && image.pixel(29, 23) != QRgb(0));
+    QCOMPARE(image.pixel(30, 23), active);
+    QVERIFY(image.pixel(31, 23) != active && image.pixel(31, 23) != QRgb(0));
+    QCOMPARE(image.pixel(32, 23), QRgb(0));
+
+    // The clock jumping, as after a suspend, places the cells again.
+    heatmap.m_currentDateTime = []() {
+        return QDateTime(TUESDAY, QTime(11, 0, 1));
+    };
+    history->record(false);
+    heatmap.refresh();
+    QCOMPARE(image.pixel(30, 23), QRgb(0));
+    QCOMPARE(image.pixel(30, 22), QRgb(0));
+    QVERIFY(image.pixel(59, 22) != QRgb(0));
+    QCOMPARE(image.pixel(0, 23), heatmap.palette().color(QPalette::Base).rgb());
+}
+
+void RSIActivityHeatmapTest::week()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+    history->record(true, 24 * RSIActivityHistory::HOUR + 15 * 60);
+
+    // From Monday midnight.
+    RSIActivityHeatmap heatmap(*history);
+    heatmap.setPeriod(RSIActivityHeatmap::Period::Week);
+    setCurrentDateTime(heatmap, QDateTime(TUESDAY, QTime(0, 15)));
+    const QRgb active = heatmap.palette().color(QPalette::Highlight).rgb();
+
+    const QImage &image = heatmap.image();
+    QCOMPARE(image.size(), QSize(96, 7));
+    QCOMPARE(image.pixel(0, 5), active);
+    QCOMPARE(image.pixel(95, 5), active);
+    QCOMPARE(image.pixel(0, 6), active);
+    QCOMPARE(image.pixel(1, 6), QRgb(0));
+    QCOMPARE(heatmap.rowLabel(heatmap.m_row), QLocale().dayName(Qt::Tuesday, QLocale::ShortFormat));
+}
+
+void RSIActivityHeatmapTest::incremental()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+    RSIActivityHeatmap heatmap(*history);
+    QRandomGenerator random(20);
+
+    // A clock which moves with the recorded seconds, starting off the minute.
+    const QDateTime start(TUESDAY, QTime(9, 20, 17));
+    setCurrentDateTime(heatmap, start);
+    auto clock = [&history, start]() {
+        return start.addSecs(history->recordedSeconds());
+    };
+    heatmap.m_currentDateTime = clock;
+
+    // Three hours, so new rows start on the way, refreshed as the dialog
+    // does it: about once a second.
+    for (int second = 1; second <= 3 * RSIActivityHistory::HOUR; ++second) {
+        history->record(random.bounded(3) != 0);
+        if (random.bounded(10) != 0) {
+            heatmap.refresh();
+        }
+        if (second % 97 == 0) {
+            heatmap.refresh();
+            RSIActivityHeatmap rebuilt(*history);
+            rebuilt.m_currentDateTime = clock;
+            rebuilt.setPeriod(rebuilt.period());
+            QCOMPARE(heatmap.image(), rebuilt.image());
+        }
+    }
+}
@@ -0,0 +1,20 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIACTIVITYHEATMAP_TEST_H
+#define RSIBREAK_RSIACTIVITYHEATMAP_TEST_H
+
+#include <QtTest>
+
+class RSIActivityHeatmapTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cells();
+    void wallClock();
+    void week();
+    void incremental();
+};
+
+#endif // RSIBREAK_RSIACTIVITYHEATMAP_TEST_H
@@ -0,0 +1,99 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiactivityhistory_test.h"
+
+#include "rsiactivityhistory.h"
+
+#include <QRandomGenerator>
+#include <algorithm>
+#include <memory>
+
+// Counts the active seconds of the last @p seconds the slow way, from the
+// number of active seconds before every recorded second.
+static qint64 countActive(const QVector<qint64> &activeBefore, qint64 seconds)
+{
+    const qint64 recorded = activeBefore.size() - 1;
+    seconds = std::min<qint64>({seconds, recorded, RSIActivityHistory::CAPACITY});
+    return activeBefore[recorded] - activeBefore[recorded - seconds];
+}
+
+void RSIActivityHistoryTest::fixedWindows()
+{
+    // About 78 KiB, too much for the stack.
+    auto history = std::make_unique<RSIActivityHistory>();
+
+    // Half an hour of work, then ten minutes idle.
+    history->record(true, 30 * 60);
+    history->record(false, 10 * 60);
+
+    QCOMPARE(history->recordedSeconds(), qint64(40 * 60));
+    QCOMPARE(history->activeSeconds(60), qint64(0));
+    QCOMPARE(history->activeSeconds(15 * 60), qint64(5 * 60));
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::HOUR), qint64(30 * 60));
+    QCOMPARE(history->activeFraction(RSIActivityHistory::HOUR), 0.5);
+    QCOMPARE(history->activeFraction(0), 0.0);
+
+    history->reset();
+    QCOMPARE(history->recordedSeconds(), qint64(0));
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::HOUR), qint64(0));
+}
+
+void RSIActivityHistoryTest::randomWindows()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+    QVector<qint64> activeBefore{0};
+    QRandomGenerator random(42);
+
+    // Well past the capacity, so the rings wrap around a few times.
+    while (activeBefore.size() < 3 * RSIActivityHistory::CAPACITY) {
+        const bool active = random.bounded(2);
+        const int seconds = random.bounded(10) ? random.bounded(90) : random.bounded(5 * RSIActivityHistory::HOUR);
+        history->record(active, seconds);
+        for (int i = 0; i < seconds; ++i) {
+            activeBefore.append(activeBefore.constLast() + active);
+        }
+
+        const qint64 window = random.bounded(RSIActivityHistory::CAPACITY + 1);
+        QCOMPARE(history->activeSeconds(window), countActive(activeBefore, window));
+        QCOMPARE(history->activeSeconds(RSIActivityHistory::CAPACITY), countActive(activeBefore, RSIActivityHistory::CAPACITY));
+    }
+}
+
+void RSIActivityHistoryTest::longIdle()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+
+    history->record(true, 90);
+    history->record(false, 2 * RSIActivityHistory::CAPACITY + 17);
+    history->record(true, 10);
+
+    QCOMPARE(history->recordedSeconds(), 2LL * RSIActivityHistory::CAPACITY + 117);
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::CAPACITY), qint64(10));
+    QCOMPARE(history->activeSeconds(60), qint64(10));
+}
+
+void RSIActivityHistoryTest::fullWrap()
+{
+    auto history = std::make_unique<RSIActivityHistory>();
+
+    // More than the whole week at once, starting in the middle of a minute.
+    history->record(false, 30);
+    history->record(true, RSIActivityHistory::CAPACITY + 30);
+    for (const qint64 seconds : {qint64(1), qint64(30), qint64(90), qint64(RSIActivityHistory::HOUR), qint64(RSIActivityHistory::HOUR + 45), qint64(RSIActivityHistory::CAPACITY)}) {
+        QCOMPARE(history->activeSeconds(seconds), seconds);
+    }
+
+    // The minute and hour in progress count on from there.
+    history->record(false, 20);
+    history->record(true, 5);
+    QCOMPARE(history->activeSeconds(25), qint64(5));
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::HOUR), qint64(RSIActivityHistory::HOUR - 20));
+
+    history->record(false, RSIActivityHistory::CAPACITY + 30);
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::CAPACITY), qint64(0));
+    history->record(true, 45);
+    QCOMPARE(history->activeSeconds(100), qint64(45));
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::CAPACITY), qint64(45));
+}
@@ -0,0 +1,22 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIACTIVITYHISTORY_TEST_H
+#define RSIBREAK_RSIACTIVITYHISTORY_TEST_H
+
+#include <QtTest>
+
+class RSIActivityHistoryTest : public QObject
+{
+private:
+    Q_OBJECT
+
+private slots:
+    void fixedWindows();
+    void randomWindows();
+    void longIdle();
+    void fullWrap();
+};
+
+#endif // RSIBREAK_RSIACTIVITYHISTORY_TEST_H
@@ -0,0 +1,106 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiactivitylog_test.h"
+
+#include "rsiactivityhistory.h"
+#include "rsiactivitylog.h"
+
+#include <memory>
+
+// Noon, away from the clocks changing.
+static const qint64 NOON = QDateTime(QDate(2024, 3, 5), QTime(12, 0)).toSecsSinceEpoch();
+
+void RSIActivityLogTest::init()
+{
+    QDir(m_dir.path()).removeRecursively();
+    QVERIFY(QDir().mkpath(m_dir.path()));
+}
+
+void RSIActivityLogTest::replayAfterRestart()
+{
+    {
+        RSIActivityLog log(m_dir.path());
+        log.record(true, 1000, NOON);
+        log.record(false, 200, NOON + 200);
+        // Not flushed yet, the destructor writes the rest.
+        log.record(true, 3, NOON + 203);
+    }
+
+    QFile file(RSIActivityLog(m_dir.path()).dayPath(QDate(2024, 3, 5)));
+    QVERIFY(file.exists());
+    QVERIFY(file.size() < 12 * 1024);
+
+    RSIActivityLog log(m_dir.path());
+    auto history = std::make_unique<RSIActivityHistory>();
+    log.replay(*history, NOON + 203);
+    QCOMPARE(history->recordedSeconds(), qint64(RSIActivityHistory::CAPACITY));
+    QCOMPARE(history->activeSeconds(3), qint64(3));
+    QCOMPARE(history->activeSeconds(203), qint64(3));
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::HOUR), qint64(1003));
+}
+
+void RSIActivityLogTest::rotateByDay()
+{
+    const qint64 midnight = QDate(2024, 3, 6).startOfDay().toSecsSinceEpoch();
+    {
+        RSIActivityLog log(m_dir.path());
+        log.record(true, 600, midnight + 300);
+    }
+
+    RSIActivityLog log(m_dir.path());
+    QVERIFY(QFile::exists(log.dayPath(QDate(2024, 3, 5))));
+    QVERIFY(QFile::exists(log.dayPath(QDate(2024, 3, 6))));
+
+    auto history = std::make_unique<RSIActivityHistory>();
+    log.replay(*history, midnight + 300);
+    QCOMPARE(history->activeSeconds(RSIActivityHistory::HOUR), qint64(600));
+}
+
+void RSIActivityLogTest::events()
+{
+    {
+        RSIActivityLog log(m_dir.path());
+        log.record(true, 10, NOON);
+        log.recordEvent(TINY_BREAKS, NOON);
+        log.recordEvent(BIG_BREAKS_SKIPPED, NOON + 1);
+    }
+
+    QFile file(RSIActivityLog(m_dir.path()).dayPath(QDate(2024, 3, 5)));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    RSIActivityLog::Event event;
+    QVERIFY(file.seek(file.size() - 2 * qint64(sizeof(event))));
+    QCOMPARE(file.read(reinterpret_cast<char *>(&event), sizeof(event)), qint64(sizeof(event)));
+    QCOMPARE(event.time, NOON);
+    QCOMPARE(event.stat, qint32(TINY_BREAKS));
+    QCOMPARE(file.read(reinterpret_cast<char *>(&event), sizeof(event)), qint64(sizeof(event)));
+    QCOMPARE(event.time, NOON + 1);
+    QCOMPARE(event.stat, qint32(BIG_BREAKS_SKIPPED));
+}
+
+void RSIActivityLogTest::flushOnQuit()
+{
+    RSIActivityLog log(m_dir.path());
+    log.flushOnQuit();
+    log.record(true, 10, NOON);
+    // Well within FLUSH_INTERVAL of the first record, so only in memory.
+    log.record(true, 20, NOON + 30);
+    log.recordEvent(TINY_BREAKS, NOON + 30);
+
+    const QDate date(2024, 3, 5);
+    const int tail = int(NOON + 25 - date.startOfDay().toSecsSinceEpoch());
+    {
+        RSIActivityLog::Day day(log, date);
+        QVERIFY(day.isValid());
+        QVERIFY(!day.isActive(tail));
+        QVERIFY(day.events().isEmpty());
+    }
+
+    // What QCoreApplication::quit() sends on the way out.
+    QVERIFY(QMetaObject::invokeMethod(QCoreApplication::instance(), "aboutToQuit", Qt::DirectConnection));
+    RSIActivityLog::Day day(log, date);
+    QVERIFY(day.isActive(tail));
+    QCOMPARE(day.events().size(), 1);
+    QCOMPARE(day.events().constFirst().stat, qint32(TINY_BREAKS));
+}
@@ -0,0 +1,25 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIACTIVITYLOG_TEST_H
+#define RSIBREAK_RSIACTIVITYLOG_TEST_H
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+class RSIActivityLogTest : public QObject
+{
+private:
+    Q_OBJECT
+    QTemporaryDir m_dir;
+
+private slots:
+    void init();
+    void replayAfterRestart();
+    void rotateByDay();
+    void events();
+    void flushOnQuit();
+};
+
+#endif // RSIBREAK_RSIACTIVITYLOG_TEST_H
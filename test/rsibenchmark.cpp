@@ -0,0 +1,394 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsibenchmark.h"
+
+#include <KFormat>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+
+#include "rsiactivityheatmap.h"
+#include "rsiactivityhistory.h"
+#include "rsidock.h"
+#include "rsiglobals.h"
+#include "rsihistory.h"
+#include "rsiidletrace.h"
+#include "rsisimulator.h"
+#include "rsistats.h"
+#include "rsistatsbaseline.h"
+#include "rsistatsmodel.h"
+#include "rsitimer.h"
+#include "slideshoweffect.h"
+
+// Long enough for the timer not to leave the state being measured.
+static constexpr int FOREVER = INT_MAX / 2;
+
+RSIBenchmark::RSIBenchmark()
+{
+    m_intervals.resize(INTERVAL_COUNT);
+    m_intervals[TINY_BREAK_INTERVAL] = FOREVER;
+    m_intervals[TINY_BREAK_DURATION] = 20;
+    m_intervals[TINY_BREAK_THRESHOLD] = 60;
+    m_intervals[BIG_BREAK_INTERVAL] = FOREVER;
+    m_intervals[BIG_BREAK_DURATION] = 60;
+    m_intervals[BIG_BREAK_THRESHOLD] = 5 * 60;
+    m_intervals[POSTPONE_BREAK_INTERVAL] = 3 * 60;
+    m_intervals[PATIENCE_INTERVAL] = FOREVER;
+    // Every tick is long input, which keeps a suggested break waiting.
+    m_intervals[SHORT_INPUT_INTERVAL] = 1;
+}
+
+void RSIBenchmark::initTestCase()
+{
+    // A corpus of photo sized images, in both lossless and lossy formats.
+    QVERIFY(m_imageDir.isValid());
+    const QList<QSize> sizes = {{1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160}};
+    for (int i = 0; i < sizes.size(); ++i) {
+        QImage image(sizes[i], QImage::Format_RGB32);
+        QPainter painter(&image);
+        QLinearGradient gradient(0, 0, image.width(), image.height());
+        gradient.setColorAt(0, QColor::fromHsv(i * 60, 200, 255));
+        gradient.setColorAt(1, QColor::fromHsv(i * 60 + 180, 255, 64));
+        painter.fillRect(image.rect(), gradient);
+        painter.end();
+        QVERIFY(image.save(m_imageDir.filePath(QStringLiteral("image%1.png").arg(i))));
+        QVERIFY(image.save(m_imageDir.filePath(QStringLiteral("image%1.jpg").arg(i))));
+    }
+}
+
+void RSIBenchmark::timerTimeout_data()
+{
+    QTest::addColumn<int>("state");
+    QTest::addColumn<bool>("idle");
+
+    QTest::newRow("monitoring active") << (int)RSITimer::TimerState::Monitoring << false;
+    QTest::newRow("monitoring idle") << (int)RSITimer::TimerState::Monitoring << true;
+    QTest::newRow("suggesting") << (int)RSITimer::TimerState::Suggesting << false;
+    QTest::newRow("resting") << (int)RSITimer::TimerState::Resting << false;
+    QTest::newRow("suspended") << (int)RSITimer::TimerState::Suspended << false;
+}
+
+void RSIBenchmark::timerTimeout()
+{
+    QFETCH(int, state);
+    QFETCH(bool, idle);
+
+    RSITimer timer(std::unique_ptr<RSIIdleTime>(new RSIIdleTimeFake()), m_intervals, true, true);
+    switch ((RSITimer::TimerState)state) {
+    case RSITimer::TimerState::Suggesting:
+        timer.suggestBreak(0, m_intervals[TINY_BREAK_DURATION]);
+        break;
+    case RSITimer::TimerState::Resting:
+        timer.transition(RSITimer::TimerEvent::BreakNow, FOREVER);
+        break;
+    case RSITimer::TimerState::Suspended:
+        timer.slotStop();
+        break;
+    default:
+        break;
+    }
+    timer.m_isIdle = idle;
+    timer.m_idleStartMs = timer.m_clock->monotonicMSecs() - 1000;
+
+    QBENCHMARK {
+        timer.timeout();
+    }
+    QCOMPARE((int)timer.m_state, state);
+}
+
+void RSIBenchmark::statsIncrease_data()
+{
+    QTest::addColumn<bool>("visible");
+
+    QTest::newRow("hidden") << false;
+    QTest::newRow("visible") << true;
+}
+
+void RSIBenchmark::statsIncrease()
+{
+    QFETCH(bool, visible);
+
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    RSIStatsModel model(stats);
+    model.setActive(visible);
+    // ACTIVITY has the most derived statistics, the bit array ones included.
+    QBENCHMARK {
+        stats->increaseStat(ACTIVITY);
+    }
+}
+
+void RSIBenchmark::statsSetMax_data()
+{
+    statsIncrease_data();
+}
+
+void RSIBenchmark::statsSetMax()
+{
+    QFETCH(bool, visible);
+
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    RSIStatsModel model(stats);
+    model.setActive(visible);
+    int idle = 0;
+    QBENCHMARK {
+        stats->setStat(MAX_IDLENESS, ++idle, true);
+    }
+}
+
+void RSIBenchmark::statsTick_data()
+{
+    QTest::addColumn<bool>("baseline");
+
+    QTest::newRow("QVariant items") << true;
+    QTest::newRow("typed") << false;
+}
+
+void RSIBenchmark::statsTick()
+{
+    QFETCH(bool, baseline);
+
+    // What RSITimer::accountTicks() records for a second of activity.
+    if (baseline) {
+        RSIStatsBaseline stats;
+        QBENCHMARK {
+            stats.increaseStat(TOTAL_TIME);
+            stats.setStat(CURRENT_IDLE_TIME, 0);
+            stats.increaseStat(ACTIVITY);
+        }
+        return;
+    }
+
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    QBENCHMARK {
+        stats->increaseStat(TOTAL_TIME);
+        stats->setCounter(CURRENT_IDLE_TIME, 0);
+        stats->increaseStat(ACTIVITY);
+    }
+}
+
+void RSIBenchmark::activityRecord_data()
+{
+    QTest::addColumn<bool>("active");
+    QTest::addColumn<int>("seconds");
+
+    QTest::newRow("active second") << true << 1;
+    QTest::newRow("idle second") << false << 1;
+    QTest::newRow("idle night") << false << 14 * RSIActivityHistory::HOUR;
+}
+
+void RSIBenchmark::activityRecord()
+{
+    QFETCH(bool, active);
+    QFETCH(int, seconds);
+
+    auto history = std::make_unique<RSIActivityHistory>();
+    QBENCHMARK {
+        history->record(active, seconds);
+    }
+}
+
+void RSIBenchmark::activityFraction_data()
+{
+    QTest::addColumn<int>("window");
+
+    QTest::newRow("minute") << RSIActivityHistory::MINUTE;
+    QTest::newRow("6 hours") << 6 * RSIActivityHistory::HOUR;
+    QTest::newRow("week") << RSIActivityHistory::CAPACITY;
+}
+
+void RSIBenchmark::activityFraction()
+{
+    QFETCH(int, window);
+
+    // A week of alternating work and pauses, off the minute boundaries.
+    auto history = std::make_unique<RSIActivityHistory>();
+    while (history->recordedSeconds() < RSIActivityHistory::CAPACITY) {
+        history->record(true, 25 * 60 + 7);
+        history->record(false, 5 * 60 + 3);
+    }
+
+    double fraction = 0;
+    QBENCHMARK {
+        fraction += history->activeFraction(window);
+    }
+    QVERIFY(fraction >= 0);
+}
+
+void RSIBenchmark::heatmapRefresh_data()
+{
+    QTest::addColumn<RSIActivityHeatmap::Period>("period");
+
+    QTest::newRow("day") << RSIActivityHeatmap::Period::Day;
+    QTest::newRow("week") << RSIActivityHeatmap::Period::Week;
+}
+
+void RSIBenchmark::heatmapRefresh()
+{
+    QFETCH(RSIActivityHeatmap::Period, period);
+
+    auto history = std::make_unique<RSIActivityHistory>();
+    history->record(true, RSIActivityHistory::CAPACITY - RSIActivityHistory::HOUR);
+
+    // As large as it gets on a 4K screen, what the dialog does every second.
+    RSIActivityHeatmap heatmap(*history);
+    heatmap.setPeriod(period);
+    heatmap.resize(3840, 2160);
+    QBENCHMARK {
+        history->record(true);
+        heatmap.refresh();
+    }
+}
+
+void RSIBenchmark::historyYear_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("cold") << false;
+    QTest::newRow("cached") << true;
+}
+
+void RSIBenchmark::historyYear()
+{
+    QFETCH(bool, cached);
+
+    // A year of working days, 25 minutes of work and 5 of pause from 9 to 17.
+    RSIActivityLog log(m_historyDir.path());
+    const QDate today = QDate::currentDate();
+    if (!QFile::exists(log.dayPath(today.addDays(-1)))) {
+        for (QDate date = today.addDays(-365); date < today; date = date.addDays(1)) {
+            if (date.dayOfWeek() > 5) {
+                continue;
+            }
+            for (qint64 time = QDateTime(date, QTime(9, 0)).toSecsSinceEpoch(); time < QDateTime(date, QTime(17, 0)).toSecsSinceEpoch(); time += 30 * 60) {
+                log.record(true, 25 * 60, time + 25 * 60);
+                log.recordEvent(TINY_BREAKS, time + 25 * 60);
+                log.record(false, 5 * 60, time + 30 * 60);
+            }
+        }
+        log.flush();
+    }
+
+    RSIHistory history(&log);
+    history.query(today.addDays(-364), today, RSIHistory::Grouping::Week);
+    QBENCHMARK {
+        if (!cached) {
+            history = RSIHistory(&log);
+        }
+        history.query(today.addDays(-364), today, RSIHistory::Grouping::Week);
+    }
+}
+
+void RSIBenchmark::replayIdleTrace()
+{
+    QFile file(QFINDTESTDATA("traces/office-morning.rsitrace"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVector<RSISimulator::TraceEvent> trace;
+    QString error;
+    QVERIFY2(RSISimulator::readIdleTrace(&file, trace, &error), qPrintable(error));
+
+    // The intervals the trace was captured with.
+    QVector<int> intervals = m_intervals;
+    intervals[TINY_BREAK_INTERVAL] = 15 * 60;
+    intervals[BIG_BREAK_INTERVAL] = 60 * 60;
+    intervals[PATIENCE_INTERVAL] = 30;
+    intervals[SHORT_INPUT_INTERVAL] = 2;
+
+    // Three hours of notifications, replayed on the virtual clock.
+    QString timeline;
+    QBENCHMARK {
+        timeline.clear();
+        QTextStream out(&timeline);
+        RSISimulator simulator(intervals, true, true, out);
+        simulator.run(trace, trace.constLast().second);
+    }
+}
+
+void RSIBenchmark::counterAdvanceYear()
+{
+    // A year of 1 Hz activity, in steps of an hour like the deadline
+    // scheduler wakes up at most.
+    static constexpr int YEAR = 365 * 24 * 60 * 60;
+    QBENCHMARK {
+        RSITimerCounter counter(15 * 60, 20, 60);
+        int breaks = 0;
+        for (int second = 0; second < YEAR; second += 60 * 60) {
+            breaks += counter.advance(60 * 60, 0, false);
+        }
+        QCOMPARE(breaks, YEAR / (15 * 60));
+    }
+}
+
+void RSIBenchmark::simulateYear()
+{
+    const QVector<RSISimulator::TraceEvent> trace = RSISimulator::officeTrace(365, 1);
+    QVector<int> intervals = m_intervals;
+    intervals[TINY_BREAK_INTERVAL] = 15 * 60;
+    intervals[BIG_BREAK_INTERVAL] = 60 * 60;
+    intervals[PATIENCE_INTERVAL] = 30;
+    intervals[SHORT_INPUT_INTERVAL] = 2;
+
+    // rsibreak-sim is meant to simulate a year in under a second.
+    QString timeline;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    {
+        QTextStream out(&timeline);
+        RSISimulator simulator(intervals, true, true, out);
+        simulator.run(trace, 365 * 24 * 60 * 60LL);
+    }
+    QVERIFY2(elapsed.elapsed() < 1000, qPrintable(QStringLiteral("a year took %1 ms").arg(elapsed.elapsed())));
+
+    QBENCHMARK {
+        timeline.clear();
+        QTextStream out(&timeline);
+        RSISimulator simulator(intervals, true, true, out);
+        simulator.run(trace, 365 * 24 * 60 * 60LL);
+    }
+}
+
+void RSIBenchmark::dockSetCounters()
+{
+    RSIDock dock(nullptr);
+    int left = 0;
+    QBENCHMARK {
+        // Every call formats a different duration, like the timer does.
+        ++left;
+        dock.setCounters(left % 600, left % 3600);
+    }
+}
+
+void RSIBenchmark::formatSeconds_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("KFormat") << false;
+    QTest::newRow("cached") << true;
+}
+
+void RSIBenchmark::formatSeconds()
+{
+    QFETCH(bool, cached);
+
+    RSIGlobals *globals = RSIGlobals::instance();
+    KFormat format;
+    int left = 0;
+    QBENCHMARK {
+        // Counting down through the last hour, like the tooltip.
+        left = (left + 1) % 3600;
+        const QString text = cached ? globals->formatSeconds(left) : format.formatSpelloutDuration(left * 1000);
+        Q_UNUSED(text)
+    }
+}
+
+void RSIBenchmark::slideLoadImage()
+{
+    SlideEffect effect(nullptr);
+    effect.reset(m_imageDir.path(), false, true, false, 60);
+    QVERIFY(effect.hasImages());
+    QBENCHMARK {
+        effect.loadImage();
+    }
+}
@@ -0,0 +1,49 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIBENCHMARK_H
+#define RSIBREAK_RSIBENCHMARK_H
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+class RSIBenchmark : public QObject
+{
+    Q_OBJECT
+    QVector<int> m_intervals;
+    QTemporaryDir m_imageDir;
+    QTemporaryDir m_historyDir;
+
+public:
+    RSIBenchmark();
+
+private slots:
+    void initTestCase();
+
+    void timerTimeout_data();
+    void timerTimeout();
+    void statsIncrease_data();
+    void statsIncrease();
+    void statsSetMax_data();
+    void statsSetMax();
+    void statsTick_data();
+    void statsTick();
+    void activityRecord_data();
+    void activityRecord();
+    void activityFraction_data();
+    void activityFraction();
+    void heatmapRefresh_data();
+    void heatmapRefresh();
+    void historyYear_data();
+    void historyYear();
+    void replayIdleTrace();
+    void counterAdvanceYear();
+    void simulateYear();
+    void dockSetCounters();
+    void formatSeconds_data();
+    void formatSeconds();
+    void slideLoadImage();
+};
+
+#endif // RSIBREAK_RSIBENCHMARK_H
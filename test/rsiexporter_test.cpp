@@ -0,0 +1,171 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiexporter_test.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "rsiactivitylog.h"
+#include "rsiexporter.h"
+
+// A Monday to Wednesday, away from the clocks changing.
+static const QDate MONDAY(2024, 3, 4);
+static const QDate TUESDAY(2024, 3, 5);
+static const QDate WEDNESDAY(2024, 3, 6);
+
+static qint64 at(const QDate &date, int hour, int minute = 0)
+{
+    return QDateTime(date, QTime(hour, minute)).toSecsSinceEpoch();
+}
+
+// @returns the lines one of the exports of RSIExporter writes.
+static QStringList exportLines(const QString &directory,
+                               const RSIExporter::Format format,
+                               void (RSIExporter::*exportRows)(const QDate &, const QDate &),
+                               const QDate &from,
+                               const QDate &to)
+{
+    const RSIActivityLog log(directory);
+    QString text;
+    {
+        QTextStream out(&text);
+        RSIExporter exporter(log, out, format);
+        (exporter.*exportRows)(from, to);
+    }
+    return text.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+}
+
+// @returns the row on @p line of a JSON lines export, empty if it is not JSON.
+static QJsonObject jsonRow(const QString &line)
+{
+    return QJsonDocument::fromJson(line.toUtf8()).object();
+}
+
+void RSIExporterTest::initTestCase()
+{
+    RSIActivityLog log(m_dir.path());
+
+    // Monday: 9:00 to 9:10, then a tiny break which is taken.
+    log.record(true, 10 * 60, at(MONDAY, 9, 10));
+    log.recordEvent(TINY_BREAKS, at(MONDAY, 9, 10));
+
+    // 20 seconds across midnight.
+    log.record(true, 20, at(TUESDAY, 0) + 10);
+
+    // Tuesday: a big break which is skipped.
+    log.recordEvent(BIG_BREAKS, at(TUESDAY, 10));
+    log.recordEvent(BIG_BREAKS_SKIPPED, at(TUESDAY, 10) + 5);
+
+    // Wednesday: 14:00 to 14:01.
+    log.record(true, 60, at(WEDNESDAY, 14, 1));
+}
+
+void RSIExporterTest::daysCsv()
+{
+    const QStringList lines = exportLines(m_dir.path(), RSIExporter::Format::Csv, &RSIExporter::exportDays, MONDAY, WEDNESDAY);
+    const QStringList expected = {
+        QStringLiteral("date,active_seconds,breaks_taken,breaks_skipped,breaks_postponed,longest_stretch"),
+        QStringLiteral("2024-03-04,610,1,0,0,600"),
+        QStringLiteral("2024-03-05,10,0,1,0,10"),
+        QStringLiteral("2024-03-06,60,0,0,0,60"),
+    };
+    QCOMPARE(lines, expected);
+}
+
+void RSIExporterTest::daysJson()
+{
+    const QStringList lines = exportLines(m_dir.path(), RSIExporter::Format::JsonLines, &RSIExporter::exportDays, MONDAY, WEDNESDAY);
+    QCOMPARE(lines.size(), 3);
+
+    const QJsonObject monday = jsonRow(lines[0]);
+    QCOMPARE(monday.value(QStringLiteral("date")).toString(), QStringLiteral("2024-03-04"));
+    QCOMPARE(monday.value(QStringLiteral("active_seconds")).toInt(), 610);
+    QCOMPARE(monday.value(QStringLiteral("breaks_taken")).toInt(), 1);
+    QCOMPARE(monday.value(QStringLiteral("breaks_skipped")).toInt(), 0);
+    QCOMPARE(monday.value(QStringLiteral("breaks_postponed")).toInt(), 0);
+    QCOMPARE(monday.value(QStringLiteral("longest_stretch")).toInt(), 600);
+
+    const QJsonObject tuesday = jsonRow(lines[1]);
+    QCOMPARE(tuesday.value(QStringLiteral("date")).toString(), QStringLiteral("2024-03-05"));
+    QCOMPARE(tuesday.value(QStringLiteral("breaks_taken")).toInt(), 0);
+    QCOMPARE(tuesday.value(QStringLiteral("breaks_skipped")).toInt(), 1);
+}
+
+void RSIExporterTest::eventsCsv()
+{
+    const QStringList lines = exportLines(m_dir.path(), RSIExporter::Format::Csv, &RSIExporter::exportEvents, MONDAY, WEDNESDAY);
+    const QStringList expected = {
+        QStringLiteral("time,event"),
+        QStringLiteral("2024-03-04T09:10:00,tiny_break"),
+        QStringLiteral("2024-03-05T10:00:00,big_break"),
+        QStringLiteral("2024-03-05T10:00:05,big_break_skipped"),
+    };
+    QCOMPARE(lines, expected);
+}
+
+void RSIExporterTest::eventsJson()
+{
+    const QStringList lines = exportLines(m_dir.path(), RSIExporter::Format::JsonLines, &RSIExporter::exportEvents, MONDAY, WEDNESDAY);
+    QCOMPARE(lines.size(), 3);
+    const QJsonObject skipped = jsonRow(lines[2]);
+    QCOMPARE(skipped.value(QStringLiteral("time")).toString(), QStringLiteral("2024-03-05T10:00:05"));
+    QCOMPARE(skipped.value(QStringLiteral("event")).toString(), QStringLiteral("big_break_skipped"));
+}
+
+void RSIExporterTest::activityCsv()
+{
+    const QStringList lines = exportLines(m_dir.path(), RSIExporter::Format::Csv, &RSIExporter::exportActivity, MONDAY, WEDNESDAY);
+    const QStringList expected = {
+        QStringLiteral("start,end,seconds"),
+        QStringLiteral("2024-03-04T09:00:00,2024-03-04T09:10:00,600"),
+        // The run goes on across midnight.
+        QStringLiteral("2024-03-04T23:59:50,2024-03-05T00:00:10,20"),
+        QStringLiteral("2024-03-06T14:00:00,2024-03-06T14:01:00,60"),
+    };
+    QCOMPARE(lines, expected);
+}
+
+void RSIExporterTest::activityJson()
+{
+    const QStringList lines = exportLines(m_dir.path(), RSIExporter::Format::JsonLines, &RSIExporter::exportActivity, MONDAY, WEDNESDAY);
+    QCOMPARE(lines.size(), 3);
+    const QJsonObject midnight = jsonRow(lines[1]);
+    QCOMPARE(midnight.value(QStringLiteral("start")).toString(), QStringLiteral("2024-03-04T23:59:50"));
+    QCOMPARE(midnight.value(QStringLiteral("end")).toString(), QStringLiteral("2024-03-05T00:00:10"));
+    QCOMPARE(midnight.value(QStringLiteral("seconds")).toInt(), 20);
+}
+
+void RSIExporterTest::bounds()
+{
+    QCOMPARE(RSIExporter::firstLoggedDay(m_dir.path()), MONDAY);
+
+    // Both bounds are included, and nothing outside of them is read.
+    const QStringList days = exportLines(m_dir.path(), RSIExporter::Format::Csv, &RSIExporter::exportDays, TUESDAY, TUESDAY);
+    QCOMPARE(days.size(), 2);
+    QCOMPARE(days[1], QStringLiteral("2024-03-05,10,0,1,0,10"));
+
+    // Only the part of the run after midnight is on Tuesday.
+    const QStringList activity = exportLines(m_dir.path(), RSIExporter::Format::Csv, &RSIExporter::exportActivity, TUESDAY, TUESDAY);
+    QCOMPARE(activity.size(), 2);
+    QCOMPARE(activity[1], QStringLiteral("2024-03-05T00:00:00,2024-03-05T00:00:10,10"));
+
+    const QStringList events = exportLines(m_dir.path(), RSIExporter::Format::Csv, &RSIExporter::exportEvents, WEDNESDAY, WEDNESDAY.addDays(7));
+    QCOMPARE(events, QStringList{QStringLiteral("time,event")});
+
+    // An empty range, as when nothing is logged.
+    const QStringList none = exportLines(m_dir.path(), RSIExporter::Format::JsonLines, &RSIExporter::exportDays, TUESDAY, MONDAY);
+    QVERIFY(none.isEmpty());
+}
+
+void RSIExporterTest::missingLog()
+{
+    const QString directory = m_dir.filePath(QStringLiteral("missing"));
+    QVERIFY(!RSIExporter::firstLoggedDay(directory).isValid());
+
+    const QStringList lines = exportLines(directory, RSIExporter::Format::Csv, &RSIExporter::exportDays, MONDAY, WEDNESDAY);
+    QCOMPARE(lines.size(), 1);
+    // Reading the log does not create it.
+    QVERIFY(!QFileInfo::exists(directory));
+}
@@ -0,0 +1,29 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIEXPORTER_TEST_H
+#define RSIBREAK_RSIEXPORTER_TEST_H
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+class RSIExporterTest : public QObject
+{
+private:
+    Q_OBJECT
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase();
+    void daysCsv();
+    void daysJson();
+    void eventsCsv();
+    void eventsJson();
+    void activityCsv();
+    void activityJson();
+    void bounds();
+    void missingLog();
+};
+
+#endif // RSIBREAK_RSIEXPORTER_TEST_H
@@ -0,0 +1,102 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsihistory_test.h"
+
+#include "rsiactivitylog.h"
+#include "rsihistory.h"
+
+// A Monday and a Wednesday, away from the clocks changing.
+static const QDate MONDAY(2024, 3, 4);
+static const QDate WEDNESDAY(2024, 3, 6);
+
+static qint64 at(const QDate &date, int hour, int minute = 0)
+{
+    return QDateTime(date, QTime(hour, minute)).toSecsSinceEpoch();
+}
+
+void RSIHistoryTest::initTestCase()
+{
+    RSIActivityLog log(m_dir.path());
+
+    // The break events come in the order the timer logs them: the suggestion
+    // first, then the skip or postponement if there is one.
+
+    // Monday: 9:00 to 10:00 with a 30 second pause, 11:00 to 11:20. A tiny
+    // break is taken at 10:00, idleness takes another one, and a big break
+    // is skipped at 11:20.
+    log.record(true, 30 * 60, at(MONDAY, 9, 30));
+    log.record(false, 30, at(MONDAY, 9, 30) + 30);
+    log.record(true, 30 * 60 - 30, at(MONDAY, 10));
+    log.recordEvent(TINY_BREAKS, at(MONDAY, 10));
+    log.recordEvent(TINY_BREAKS, at(MONDAY, 10, 30));
+    log.recordEvent(IDLENESS_CAUSED_SKIP_TINY, at(MONDAY, 10, 30));
+    log.record(true, 20 * 60, at(MONDAY, 11, 20));
+    log.recordEvent(BIG_BREAKS, at(MONDAY, 11, 20));
+    log.recordEvent(BIG_BREAKS_SKIPPED, at(MONDAY, 11, 20) + 5);
+
+    // Wednesday: 14:00 to 14:10. A tiny break is postponed at 14:10 and
+    // taken when suggested again.
+    log.record(true, 10 * 60, at(WEDNESDAY, 14, 10));
+    log.recordEvent(TINY_BREAKS, at(WEDNESDAY, 14, 10));
+    log.recordEvent(TINY_BREAKS_POSTPONED, at(WEDNESDAY, 14, 10) + 5);
+    log.recordEvent(TINY_BREAKS, at(WEDNESDAY, 14, 15));
+}
+
+void RSIHistoryTest::days()
+{
+    RSIActivityLog log(m_dir.path());
+    RSIHistory history(&log);
+
+    const QVector<RSIHistory::Aggregate> days = history.query(MONDAY, MONDAY.addDays(6), RSIHistory::Grouping::Day);
+    QCOMPARE(days.size(), 2);
+
+    QCOMPARE(days[0].start, MONDAY);
+    QCOMPARE(days[0].counts.activeSeconds, qint64(80 * 60 - 30));
+    QCOMPARE(days[0].counts.breaksTaken, 2);
+    QCOMPARE(days[0].counts.breaksSkipped, 1);
+    QCOMPARE(days[0].counts.breaksPostponed, 0);
+    // The pause was too short to end the stretch.
+    QCOMPARE(days[0].longestStretch, 60 * 60);
+
+    QCOMPARE(days[1].start, WEDNESDAY);
+    QCOMPARE(days[1].counts.activeSeconds, qint64(10 * 60));
+    QCOMPARE(days[1].counts.breaksTaken, 1);
+    QCOMPARE(days[1].counts.breaksSkipped, 0);
+    QCOMPARE(days[1].counts.breaksPostponed, 1);
+    QCOMPARE(days[1].longestStretch, 10 * 60);
+}
+
+void RSIHistoryTest::weeks()
+{
+    RSIActivityLog log(m_dir.path());
+    RSIHistory history(&log);
+
+    const QVector<RSIHistory::Aggregate> weeks = history.query(MONDAY.addDays(-14), MONDAY.addDays(13), RSIHistory::Grouping::Week);
+    QCOMPARE(weeks.size(), 1);
+    QCOMPARE(weeks[0].start, MONDAY);
+    QCOMPARE(weeks[0].counts.activeSeconds, qint64(90 * 60 - 30));
+    QCOMPARE(weeks[0].counts.breaksTaken, 3);
+    QCOMPARE(weeks[0].counts.breaksSkipped, 1);
+    QCOMPARE(weeks[0].counts.breaksPostponed, 1);
+    QCOMPARE(weeks[0].longestStretch, 60 * 60);
+}
+
+void RSIHistoryTest::hoursOfDay()
+{
+    RSIActivityLog log(m_dir.path());
+    RSIHistory history(&log);
+
+    const QVector<RSIHistory::Aggregate> hours = history.query(MONDAY, WEDNESDAY, RSIHistory::Grouping::HourOfDay);
+    QCOMPARE(hours.size(), 24);
+    QCOMPARE(hours[9].counts.activeSeconds, qint64(60 * 60 - 30));
+    QCOMPARE(hours[10].counts.activeSeconds, qint64(0));
+    QCOMPARE(hours[10].counts.breaksTaken, 2);
+    QCOMPARE(hours[11].counts.activeSeconds, qint64(20 * 60));
+    QCOMPARE(hours[11].counts.breaksTaken, 0);
+    QCOMPARE(hours[11].counts.breaksSkipped, 1);
+    QCOMPARE(hours[14].counts.activeSeconds, qint64(10 * 60));
+    QCOMPARE(hours[14].counts.breaksTaken, 1);
+    QCOMPARE(hours[14].counts.breaksPostponed, 1);
+}
@@ -0,0 +1,24 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIHISTORY_TEST_H
+#define RSIBREAK_RSIHISTORY_TEST_H
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+class RSIHistoryTest : public QObject
+{
+private:
+    Q_OBJECT
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase();
+    void days();
+    void weeks();
+    void hoursOfDay();
+};
+
+#endif // RSIBREAK_RSIHISTORY_TEST_H
@@ -0,0 +1,50 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiidletime_test.h"
+
+#include <QTemporaryDir>
+
+#include "rsiidlebackends.h"
+
+void RSIIdleTimeTest::backends()
+{
+    const QStringList backends = RSIIdleTime::backends();
+    QCOMPARE(backends.constFirst(), QStringLiteral("kidletime"));
+    QVERIFY(backends.contains(QStringLiteral("logind")));
+    QVERIFY(backends.contains(QStringLiteral("replay")));
+}
+
+void RSIIdleTimeTest::replay()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("idle.trace"));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write("# idle right away, back after a second\n"
+               "0 idle\n"
+               "0 skip\n"
+               "1 active\n");
+    file.close();
+
+    RSIIdleTimeReplay idleTime(path);
+    QSignalSpy reached(&idleTime, &RSIIdleTime::idleTimeoutReached);
+    QSignalSpy resumed(&idleTime, &RSIIdleTime::resumingFromIdle);
+    idleTime.addIdleTimeout(300);
+    idleTime.addIdleTimeout(100);
+    // Longer than the idle period, never reached.
+    idleTime.addIdleTimeout(5000);
+
+    // In order, each once.
+    QTRY_COMPARE(reached.count(), 2);
+    QCOMPARE(reached[0][0].toInt(), 100);
+    QCOMPARE(reached[1][0].toInt(), 300);
+    QCOMPARE(resumed.count(), 0);
+
+    QTRY_COMPARE(resumed.count(), 1);
+    QCOMPARE(reached.count(), 2);
+    QCOMPARE(idleTime.latency().count, 2);
+    QVERIFY(idleTime.latency().maxMs >= 0);
+}
@@ -0,0 +1,20 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIIDLETIME_TEST_H
+#define RSIBREAK_RSIIDLETIME_TEST_H
+
+#include <QtTest>
+
+class RSIIdleTimeTest : public QObject
+{
+private:
+    Q_OBJECT
+
+private slots:
+    void backends();
+    void replay();
+};
+
+#endif // RSIBREAK_RSIIDLETIME_TEST_H
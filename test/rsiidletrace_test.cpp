@@ -0,0 +1,142 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsiidletrace_test.h"
+
+#include <QBuffer>
+#include <QTemporaryDir>
+
+#include "rsiclock.h"
+#include "rsiglobals.h"
+#include "rsiidletime.h"
+#include "rsiidletrace.h"
+#include "rsisimulator.h"
+
+// The intervals the fixtures in traces/ were captured with.
+static QVector<int> fixtureIntervals()
+{
+    QVector<int> intervals(INTERVAL_COUNT);
+    intervals[TINY_BREAK_INTERVAL] = 15 * 60;
+    intervals[TINY_BREAK_DURATION] = 20;
+    intervals[TINY_BREAK_THRESHOLD] = 60;
+    intervals[BIG_BREAK_INTERVAL] = 60 * 60;
+    intervals[BIG_BREAK_DURATION] = 60;
+    intervals[BIG_BREAK_THRESHOLD] = 5 * 60;
+    intervals[POSTPONE_BREAK_INTERVAL] = 3 * 60;
+    intervals[PATIENCE_INTERVAL] = 30;
+    intervals[SHORT_INPUT_INTERVAL] = 2;
+    return intervals;
+}
+
+// Simulates @p fileName from traces/ and @returns the timeline counts.
+static QMap<QString, int> simulate(const QString &fileName)
+{
+    QFile file(QFINDTESTDATA(QStringLiteral("traces/") + fileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Missing fixture" << fileName;
+        return {};
+    }
+    QVector<RSISimulator::TraceEvent> trace;
+    QString error;
+    const bool read = RSIIdleTrace::isTrace(&file) ? RSISimulator::readIdleTrace(&file, trace, &error) : RSISimulator::readTrace(&file, trace, &error);
+    if (!read || trace.isEmpty()) {
+        qWarning() << fileName << error;
+        return {};
+    }
+
+    QString timeline;
+    QTextStream out(&timeline);
+    RSISimulator simulator(fixtureIntervals(), true, true, out);
+    simulator.run(trace, trace.constLast().second + 10 * 60);
+    return simulator.counts();
+}
+
+void RSIIdleTraceTest::roundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("idle.rsitrace"));
+
+    RSIClockFake clock;
+    clock.advance(123456789);
+    RSIIdleTimeFake idleTime;
+    {
+        RSIIdleTraceWriter writer(path, &clock);
+        writer.watch(&idleTime);
+        writer.watch(&idleTime);
+
+        clock.advance(1000);
+        idleTime.simulateIdleTimeout(1000);
+        clock.advance(299000);
+        idleTime.simulateIdleTimeout(300000);
+        clock.advance(12345);
+        idleTime.simulateResumeFromIdle();
+        clock.advance(1000);
+        idleTime.simulateIdleTimeout(1000);
+    }
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(RSIIdleTrace::isTrace(&file));
+    // 13 bytes of header, the events take 2 to 6 bytes each.
+    QCOMPARE(file.size(), qint64(13 + 17));
+
+    QVector<RSIIdleTrace::Event> events;
+    QString error;
+    QVERIFY(RSIIdleTrace::read(&file, events, &error));
+    QCOMPARE(events.size(), 4);
+    QCOMPARE(events[0].ms, qint64(1000));
+    QVERIFY(events[0].kind == RSIIdleTrace::Kind::IdleTimeout);
+    QCOMPARE(events[0].msec, 1000);
+    QCOMPARE(events[1].ms, qint64(300000));
+    QCOMPARE(events[1].msec, 300000);
+    QCOMPARE(events[2].ms, qint64(312345));
+    QVERIFY(events[2].kind == RSIIdleTrace::Kind::Resume);
+    QCOMPARE(events[3].ms, qint64(313345));
+    QVERIFY(events[3].kind == RSIIdleTrace::Kind::IdleTimeout);
+
+    // Whole seconds for the simulator.
+    file.seek(0);
+    QVector<RSISimulator::TraceEvent> trace;
+    QVERIFY(RSISimulator::readIdleTrace(&file, trace, &error));
+    QCOMPARE(trace.size(), 4);
+    QCOMPARE(trace[1].second, qint64(300));
+    QVERIFY(trace[1].action == RSISimulator::TraceAction::Idle);
+    QCOMPARE(trace[1].idleMsec, 300000);
+    QCOMPARE(trace[2].second, qint64(312));
+    QVERIFY(trace[2].action == RSISimulator::TraceAction::Active);
+}
+
+void RSIIdleTraceTest::malformed()
+{
+    QByteArray data("RSIT\x01", 5);
+    data.append(8, '\0');
+    data.append('\x80'); // a varint cut short
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QVERIFY(RSIIdleTrace::isTrace(&buffer));
+    QVector<RSIIdleTrace::Event> events;
+    QString error;
+    QVERIFY(!RSIIdleTrace::read(&buffer, events, &error));
+    QVERIFY(!error.isEmpty());
+
+    QByteArray text("0 idle\n");
+    QBuffer textBuffer(&text);
+    QVERIFY(textBuffer.open(QIODevice::ReadOnly));
+    QVERIFY(!RSIIdleTrace::isTrace(&textBuffer));
+}
+
+void RSIIdleTraceTest::officeMorning()
+{
+    // The captured notifications, and the same idle periods as a text trace.
+    const QMap<QString, int> captured = simulate(QStringLiteral("office-morning.rsitrace"));
+    const QMap<QString, int> text = simulate(QStringLiteral("office-morning.trace"));
+    QVERIFY(!captured.isEmpty());
+
+    QVERIFY(captured.value(QStringLiteral("suggest")) > 0);
+    // At least the pause of 7 minutes.
+    QVERIFY(captured.value(QStringLiteral("idle-reset")) > 0);
+    QCOMPARE(captured, text);
+}
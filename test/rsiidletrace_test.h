@@ -0,0 +1,21 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSIIDLETRACE_TEST_H
+#define RSIBREAK_RSIIDLETRACE_TEST_H
+
+#include <QtTest>
+
+class RSIIdleTraceTest : public QObject
+{
+private:
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void malformed();
+    void officeMorning();
+};
+
+#endif // RSIBREAK_RSIIDLETRACE_TEST_H
@@ -0,0 +1,116 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSISTATSBASELINE_H
+#define RSIBREAK_RSISTATSBASELINE_H
+
+#include <QBitArray>
+#include <QList>
+#include <QVariant>
+
+#include <memory>
+#include <vector>
+
+#include "rsiglobals.h"
+
+/**
+ * The QVariant items RSIStats used to keep its statistics in, cut down to
+ * what the statsTick benchmark touches, as the baseline row. Labels are
+ * left out, they were only updated while the statistics were shown.
+ */
+class RSIStatsBaseline
+{
+public:
+    RSIStatsBaseline()
+    {
+        for (int i = 0; i < STAT_COUNT; ++i) {
+            m_statistics.emplace_back(new Item());
+        }
+        m_statistics[TOTAL_TIME]->derived << ACTIVITY_PERC;
+        m_statistics[ACTIVITY]->derived << ACTIVITY_PERC << ACTIVITY_PERC_MINUTE << ACTIVITY_PERC_HOUR << ACTIVITY_PERC_6HOUR;
+        m_statistics[IDLENESS]->derived << ACTIVITY_PERC_MINUTE << ACTIVITY_PERC_HOUR << ACTIVITY_PERC_6HOUR;
+        m_statistics[ACTIVITY_PERC_MINUTE].reset(new BitArrayItem(m_usage, 60));
+        m_statistics[ACTIVITY_PERC_HOUR].reset(new BitArrayItem(m_usage, 3600));
+        m_statistics[ACTIVITY_PERC_6HOUR].reset(new BitArrayItem(m_usage, 6 * 3600));
+    }
+
+    void increaseStat(RSIStat stat, int delta = 1)
+    {
+        const QVariant v = m_statistics[stat]->value;
+        if (v.userType() == QMetaType::Int)
+            m_statistics[stat]->value = v.toInt() + delta;
+        else if (v.userType() == QMetaType::Double)
+            m_statistics[stat]->value = v.toDouble() + (double)delta;
+        updateDependentStats(stat);
+    }
+
+    void setStat(RSIStat stat, const QVariant &val)
+    {
+        m_statistics[stat]->value = val;
+        updateDependentStats(stat);
+    }
+
+private:
+    struct Item {
+        virtual ~Item() = default;
+        QVariant value = QVariant(0);
+        QList<RSIStat> derived;
+    };
+
+    // The share of active seconds among the last size ones of a day long bit array.
+    struct BitArrayItem : Item {
+        BitArrayItem(QBitArray &usage, int size)
+            : usage(usage)
+            , size(size)
+            , begin(DAY - size)
+        {
+        }
+
+        void record(bool active)
+        {
+            if (active && !usage.testBit(begin))
+                ++counter;
+            else if (!active && usage.testBit(begin) && counter > 0)
+                --counter;
+            usage.setBit(end, active);
+            value = QVariant(100.0 * (double)counter / (double)size);
+            begin = (begin + 1) % DAY;
+            end = (end + 1) % DAY;
+        }
+
+        QBitArray &usage;
+        const int size;
+        int counter = 0;
+        int begin;
+        int end = 0;
+    };
+
+    void updateDependentStats(RSIStat stat)
+    {
+        const QList<RSIStat> &stats = m_statistics[stat]->derived;
+        for (int i = 0; i < stats.count(); ++i) {
+            const RSIStat it = stats.at(i);
+            switch (it) {
+            case ACTIVITY_PERC: {
+                const double activity = m_statistics[ACTIVITY]->value.toDouble();
+                const double total = m_statistics[TOTAL_TIME]->value.toDouble();
+                m_statistics[it]->value = total > 0 ? (activity / total) * 100 : 0.0;
+                break;
+            }
+            case ACTIVITY_PERC_MINUTE:
+            case ACTIVITY_PERC_HOUR:
+            case ACTIVITY_PERC_6HOUR:
+                static_cast<BitArrayItem *>(m_statistics[it].get())->record(stat == ACTIVITY);
+                break;
+            default:;
+            }
+        }
+    }
+
+    static constexpr int DAY = 60 * 60 * 24;
+    QBitArray m_usage = QBitArray(DAY);
+    std::vector<std::unique_ptr<Item>> m_statistics;
+};
+
+#endif // RSIBREAK_RSISTATSBASELINE_H
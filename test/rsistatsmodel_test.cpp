@@ -0,0 +1,106 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsistatsmodel_test.h"
+
+#include "rsistats.h"
+#include "rsistatsmodel.h"
+
+#include <memory>
+
+// @returns the rows covered by the dataChanged() signals in @p spy, one bit per row.
+static quint32 changedRows(const QSignalSpy &spy)
+{
+    quint32 rows = 0;
+    for (const QList<QVariant> &arguments : spy) {
+        const int first = arguments[0].toModelIndex().row();
+        const int last = arguments[1].toModelIndex().row();
+        for (int row = first; row <= last; ++row) {
+            rows |= 1u << row;
+        }
+    }
+    return rows;
+}
+
+void RSIStatsModelTest::batchedRows()
+{
+    RSIStats stats;
+    RSIStatsModel model(&stats);
+    QSignalSpy spy(&model, &QAbstractItemModel::dataChanged);
+
+    // Activating brings every row up to date at once.
+    model.setActive(true);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(changedRows(spy), (1u << STAT_COUNT) - 1);
+    QCOMPARE(spy[0][1].toModelIndex().column(), int(RSIStatsModel::ValueColumn));
+    spy.clear();
+
+    // Writes are held back until the event loop runs.
+    stats.increaseStat(TINY_BREAKS);
+    stats.increaseStat(TINY_BREAKS);
+    stats.increaseStat(BIG_BREAKS);
+    QCOMPARE(spy.count(), 0);
+
+    QTRY_VERIFY(!spy.isEmpty());
+    const quint32 rows = changedRows(spy);
+    QVERIFY(rows & (1u << TINY_BREAKS));
+    QVERIFY(rows & (1u << BIG_BREAKS));
+    QVERIFY(!(rows & (1u << TOTAL_TIME)));
+    QCOMPARE(model.index(TINY_BREAKS, RSIStatsModel::ValueColumn).data().toString(), QStringLiteral("2"));
+    QCOMPARE(model.index(BIG_BREAKS, RSIStatsModel::ValueColumn).data().toString(), QStringLiteral("1"));
+}
+
+void RSIStatsModelTest::inactive()
+{
+    RSIStats stats;
+    RSIStatsModel model(&stats);
+    QSignalSpy spy(&model, &QAbstractItemModel::dataChanged);
+
+    stats.increaseStat(TINY_BREAKS);
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(!stats.isUpdating());
+
+    // The model still reads the current values.
+    QCOMPARE(model.index(TINY_BREAKS, RSIStatsModel::ValueColumn).data().toString(), QStringLiteral("1"));
+}
+
+void RSIStatsModelTest::colors()
+{
+    RSIStats stats;
+    RSIStatsModel model(&stats);
+    model.setActive(true);
+    QSignalSpy spy(&model, &QAbstractItemModel::dataChanged);
+
+    QVERIFY(!model.color(LAST_BIG_BREAK).isValid());
+    model.setColor(LAST_BIG_BREAK, Qt::red);
+    QTRY_COMPARE(changedRows(spy), 1u << LAST_BIG_BREAK);
+    QCOMPARE(model.index(LAST_BIG_BREAK, RSIStatsModel::ValueColumn).data(Qt::ForegroundRole).value<QColor>(), QColor(Qt::red));
+    spy.clear();
+
+    // The same color again is not a change.
+    model.setColor(LAST_BIG_BREAK, Qt::red);
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 0);
+}
+
+void RSIStatsModelTest::statsDestroyedFirst()
+{
+    // RSIObject deletes the statistics before the widget owning the model.
+    auto stats = std::make_unique<RSIStats>();
+    auto model = std::make_unique<RSIStatsModel>(stats.get());
+    model->setActive(true);
+    stats->increaseStat(TINY_BREAKS);
+    QSignalSpy resetSpy(model.get(), &QAbstractItemModel::modelReset);
+
+    stats.reset();
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(model->rowCount(), 0);
+    QVERIFY(!model->index(TINY_BREAKS, RSIStatsModel::ValueColumn).data().isValid());
+
+    // Neither the pending rows nor the destructor reach the statistics.
+    model->setActive(false);
+    QCoreApplication::processEvents();
+    model.reset();
+}
@@ -0,0 +1,20 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSISTATSMODEL_TEST_H
+#define RSIBREAK_RSISTATSMODEL_TEST_H
+
+#include <QtTest>
+
+class RSIStatsModelTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void batchedRows();
+    void inactive();
+    void colors();
+    void statsDestroyedFirst();
+};
+
+#endif // RSIBREAK_RSISTATSMODEL_TEST_H
@@ -0,0 +1,62 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "rsisuppressionmonitor_test.h"
+
+#include "rsisuppressionmonitor.h"
+
+void RSISuppressionMonitorTest::idleInhibited_data()
+{
+    QTest::addColumn<QString>("inhibited");
+    QTest::addColumn<bool>("idle");
+
+    QTest::newRow("none") << QString() << false;
+    QTest::newRow("idle") << QStringLiteral("idle") << true;
+    QTest::newRow("among others") << QStringLiteral("shutdown:sleep:idle:handle-lid-switch") << true;
+    QTest::newRow("others") << QStringLiteral("shutdown:sleep") << false;
+    QTest::newRow("lookalike") << QStringLiteral("idle-hint:handle-idle") << false;
+}
+
+void RSISuppressionMonitorTest::idleInhibited()
+{
+    QFETCH(QString, inhibited);
+    QFETCH(bool, idle);
+
+    QCOMPARE(RSISuppressionMonitor::isIdleInhibited(inhibited), idle);
+}
+
+void RSISuppressionMonitorTest::blockInhibited()
+{
+    RSISuppressionMonitor monitor;
+    // Whatever the session looks like, only the inhibitors count here.
+    monitor.m_fullscreen = false;
+    monitor.m_idleInhibited = false;
+    monitor.m_logind = false;
+    QVERIFY(!monitor.isSuppressed());
+
+    monitor.setBlockInhibited(QStringLiteral("sleep:idle"));
+    QVERIFY(monitor.isSuppressed());
+
+    // The last fetched state holds until the next fetch, however often read.
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(monitor.isSuppressed());
+    }
+
+    monitor.setBlockInhibited(QStringLiteral("sleep"));
+    QVERIFY(!monitor.isSuppressed());
+}
+
+void RSISuppressionMonitorTest::refreshOnRead()
+{
+    RSISuppressionMonitor monitor;
+    monitor.m_fullscreen = false;
+    monitor.m_idleInhibited = true;
+    monitor.m_logind = true;
+    monitor.m_fetching = false;
+
+    // Answered from the cache, with a fetch started for the next read.
+    QVERIFY(monitor.isSuppressed());
+    QVERIFY(monitor.m_fetching);
+    QVERIFY(monitor.isSuppressed());
+}
@@ -0,0 +1,22 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RSIBREAK_RSISUPPRESSIONMONITOR_TEST_H
+#define RSIBREAK_RSISUPPRESSIONMONITOR_TEST_H
+
+#include <QtTest>
+
+class RSISuppressionMonitorTest : public QObject
+{
+private:
+    Q_OBJECT
+
+private slots:
+    void idleInhibited_data();
+    void idleInhibited();
+    void blockInhibited();
+    void refreshOnRead();
+};
+
+#endif // RSIBREAK_RSISUPPRESSIONMONITOR_TEST_H
@@ -4,7 +4,10 @@
 
 #include "rsitimer_test.h"
 
+#include "allocationcounter.h"
+#include "rsiactivitylog.h"
 #include "rsiglobals.h"
+#include "rsistats.h"
 #include "rsitimer.h"
 
 static constexpr int RELAX_ENDED_MAGIC_VALUE = -1;
@@ -32,7 +35,7 @@ void RSITimerTest::setTimerIdleState(RSITimer &timer, int idleSeconds)
     } else {
         // User has been idle for idleSeconds
         timer.m_isIdle = true;
-        timer.m_idleStartTime = QDateTime::currentDateTime().addSecs(-idleSeconds);
+        timer.m_idleStartMs = timer.m_clock->monotonicMSecs() - idleSeconds * 1000LL;
     }
 }
 
@@ -248,7 +251,7 @@ void RSITimerTest::screenLock()
     QList<QVariant> spyRelaxSignals = spyRelax.takeFirst();
     QCOMPARE(spyRelaxSignals.at(0).toInt(), RELAX_ENDED_MAGIC_VALUE);
     QCOMPARE(spyMinimize.count(), 1);
-    QVERIFY2(timer.m_bigBreakCounter->counterLeft() < m_intervals[BIG_BREAK_INTERVAL], "Big break counter was reset on screen lock when it should have not.");
+    QVERIFY2(timer.tierCounter(RSITimer::BIG_TIER)->counterLeft() < m_intervals[BIG_BREAK_INTERVAL], "Big break counter was reset on screen lock when it should have not.");
 }
 
 void RSITimerTest::skipBreak()
@@ -272,7 +275,7 @@ void RSITimerTest::skipBreak()
     QList<QVariant> spyRelaxSignals = spyRelax.takeFirst();
     QCOMPARE(spyRelaxSignals.at(0).toInt(), RELAX_ENDED_MAGIC_VALUE);
     QCOMPARE(spyMinimize.count(), 1);
-    QVERIFY2(timer.m_bigBreakCounter->counterLeft() < m_intervals[BIG_BREAK_INTERVAL], "Big break counter was reset on skip break when it should have not.");
+    QVERIFY2(timer.tierCounter(RSITimer::BIG_TIER)->counterLeft() < m_intervals[BIG_BREAK_INTERVAL], "Big break counter was reset on skip break when it should have not.");
 }
 
 void RSITimerTest::noPopupBreak()
@@ -377,3 +380,495 @@ void RSITimerTest::regularBreaks()
     QCOMPARE(spyEndShortBreak.count(), tinyBreaks);
     QCOMPARE(spyEndLongBreak.count(), 1);
 }
+
+void RSITimerTest::deadlinePlanning()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSITimer timer(std::move(idle_time), m_intervals, true, true);
+
+    // Active with less than an hour left, the tooltip changes every second.
+    setTimerIdleState(timer, 0);
+    timer.timeout();
+    QCOMPARE(timer.ticksToNextDeadline(), 1);
+
+    // Idle beyond both thresholds, the next tick resets the counters.
+    setTimerIdleState(timer, m_intervals[BIG_BREAK_THRESHOLD] + 10);
+    QCOMPARE(timer.ticksToNextDeadline(), 1);
+    timer.timeout();
+    QVERIFY(timer.tierCounter(RSITimer::BIG_TIER)->isReset());
+    QVERIFY(timer.tierCounter(RSITimer::TINY_TIER)->isReset());
+
+    // From then on nothing changes until the user comes back.
+    setTimerIdleState(timer, m_intervals[BIG_BREAK_THRESHOLD] + 11);
+    QCOMPARE(timer.ticksToNextDeadline(), 0);
+
+    // Idle, but not long enough yet for the big counter.
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < 10; i++) {
+        timer.timeout();
+    }
+    setTimerIdleState(timer, 1);
+    QCOMPARE(timer.ticksToNextDeadline(), 1);
+
+    timer.slotStop();
+    QCOMPARE(timer.ticksToNextDeadline(), 0);
+    timer.slotStart();
+
+    // Suggesting a break counts down every second.
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < m_intervals[TINY_BREAK_INTERVAL]; i++) {
+        timer.timeout();
+    }
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+    QCOMPARE(timer.ticksToNextDeadline(), 1);
+}
+
+void RSITimerTest::thresholdTimeouts()
+{
+    RSIIdleTimeFake *idleTime = new RSIIdleTimeFake();
+    RSITimer timer(std::unique_ptr<RSIIdleTime>(idleTime), m_intervals, true, true);
+    const QList<int> monitoring = {1000, m_intervals[TINY_BREAK_THRESHOLD] * 1000, m_intervals[BIG_BREAK_THRESHOLD] * 1000};
+    QCOMPARE(idleTime->idleTimeouts(), monitoring);
+
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < 10; i++) {
+        timer.timeout();
+    }
+
+    // The counters reset when the backend reports each threshold.
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    const qint64 tinySkips = stats->counter(IDLENESS_CAUSED_SKIP_TINY);
+    idleTime->simulateIdleTimeout(1000);
+    QVERIFY(!timer.tierCounter(RSITimer::TINY_TIER)->isReset());
+    idleTime->simulateIdleTimeout(m_intervals[TINY_BREAK_THRESHOLD] * 1000);
+    QVERIFY(timer.tierCounter(RSITimer::TINY_TIER)->isReset());
+    QVERIFY(!timer.tierCounter(RSITimer::BIG_TIER)->isReset());
+    QCOMPARE(stats->counter(IDLENESS_CAUSED_SKIP_TINY), tinySkips + 1);
+
+    idleTime->simulateIdleTimeout(m_intervals[BIG_BREAK_THRESHOLD] * 1000);
+    QVERIFY(timer.tierCounter(RSITimer::BIG_TIER)->isReset());
+    idleTime->simulateResumeFromIdle();
+
+    // Breaks do not add a timeout at the pause length.
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < m_intervals[TINY_BREAK_INTERVAL] && timer.m_state == RSITimer::TimerState::Monitoring; i++) {
+        timer.timeout();
+    }
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+    QCOMPARE(idleTime->idleTimeouts(), monitoring);
+}
+
+void RSITimerTest::breakWhileIdle()
+{
+    RSIIdleTimeFake *idleTime = new RSIIdleTimeFake();
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer timer(std::unique_ptr<RSIIdleTime>(idleTime), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+    setTimerIdleState(timer, 0);
+
+    // The user steps away 15 seconds before a tiny break is due.
+    const int idleBefore = 15;
+    for (int i = 0; i < m_intervals[TINY_BREAK_INTERVAL] - idleBefore; i++) {
+        clock->advance(1000);
+        timer.onTickTimer();
+    }
+    idleTime->simulateIdleTimeout(1000);
+    for (int i = 0; i < idleBefore && timer.m_state == RSITimer::TimerState::Monitoring; i++) {
+        clock->advance(1000);
+        timer.onTickTimer();
+    }
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+
+    // The idle time reaches the pause length before the pause does, which
+    // does not end the break.
+    const int pause = m_intervals[TINY_BREAK_DURATION];
+    clock->advance((pause - idleBefore) * 1000LL);
+    timer.onTickTimer();
+    idleTime->simulateIdleTimeout(pause * 1000);
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+    QCOMPARE(timer.m_pauseCounter.counterLeft(), idleBefore);
+
+    // The break lasts its whole length.
+    clock->advance((idleBefore - 1) * 1000LL);
+    timer.onTickTimer();
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+    clock->advance(1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Monitoring);
+}
+
+void RSITimerTest::inputIntensity()
+{
+    RSIIdleTimeFake *idleTime = new RSIIdleTimeFake();
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer timer(std::unique_ptr<RSIIdleTime>(idleTime), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+    timer.m_useInputIntensity = true;
+    setTimerIdleState(timer, 0);
+
+    // Typing at the reference rate counts as usual.
+    idleTime->simulateInput(4);
+    clock->advance(1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 1);
+
+    // Busy seconds count twice at most.
+    for (int i = 0; i < 10; i++) {
+        idleTime->simulateInput(50);
+        clock->advance(1000);
+        timer.onTickTimer();
+    }
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 21);
+    QCOMPARE(timer.bigLeft(), m_intervals[BIG_BREAK_INTERVAL] - 21);
+
+    // Quiet ones half.
+    for (int i = 0; i < 10; i++) {
+        clock->advance(1000);
+        timer.onTickTimer();
+    }
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 26);
+
+    // A stall is weighed by the events per second over all of it.
+    idleTime->simulateInput(10 * 8);
+    clock->advance(10 * 1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 46);
+
+    // Idle seconds are not metered, and the events are dropped.
+    setTimerIdleState(timer, 5);
+    idleTime->simulateInput(100);
+    clock->advance(1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 47);
+    QCOMPARE(idleTime->takeInputEvents(), 0u);
+}
+
+void RSITimerTest::catchUpAfterStall()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer timer(std::move(idle_time), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+
+    setTimerIdleState(timer, 0);
+
+    // A regular second.
+    clock->advance(1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 1);
+
+    // The event loop was blocked, every missed second is applied.
+    clock->advance(10 * 1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 11);
+    QCOMPARE(timer.bigLeft(), m_intervals[BIG_BREAK_INTERVAL] - 11);
+
+    // Less than a second passed, nothing to do.
+    clock->advance(500);
+    timer.onTickTimer();
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 11);
+}
+
+void RSITimerTest::catchUpLogTimes()
+{
+    QTemporaryDir dir;
+    RSIActivityLog log(dir.path());
+    RSIStats *stats = RSIGlobals::instance()->stats();
+    stats->setActivityLog(&log);
+
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer timer(std::move(idle_time), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+    setTimerIdleState(timer, 0);
+
+    // A regular second, ten caught up at once and another regular one.
+    clock->advance(1000);
+    timer.onTickTimer();
+    clock->advance(10 * 1000);
+    timer.onTickTimer();
+    clock->advance(1000);
+    timer.onTickTimer();
+    log.flush();
+    stats->setActivityLog(nullptr);
+
+    // Twelve seconds in a row, none lost or written twice.
+    const qint64 end = (clock->monotonicMSecs() + timer.m_wallOffsetMs) / 1000;
+    auto isActive = [&log](const qint64 second) {
+        const RSIActivityLog::Day day(log, QDateTime::fromSecsSinceEpoch(second).date());
+        return day.isValid() && day.isActive(int(second - day.start()));
+    };
+    for (qint64 second = end - 12; second < end; ++second) {
+        QVERIFY(isActive(second));
+    }
+    QVERIFY(!isActive(end - 13));
+    QVERIFY(!isActive(end));
+}
+
+void RSITimerTest::suspendResetsCounters()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer timer(std::move(idle_time), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < 100; i++) {
+        clock->advance(1000);
+        timer.onTickTimer();
+    }
+    QCOMPARE(timer.bigLeft(), m_intervals[BIG_BREAK_INTERVAL] - 100);
+
+    // A stall of two minutes is work time.
+    clock->advance(120 * 1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.bigLeft(), m_intervals[BIG_BREAK_INTERVAL] - 220);
+
+    // Two minutes of suspend-to-RAM count as a break.
+    clock->suspend(120 * 1000);
+    clock->advance(1000);
+    timer.onTickTimer();
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Monitoring);
+    QCOMPARE(timer.bigLeft(), m_intervals[BIG_BREAK_INTERVAL] - 1);
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 1);
+}
+
+void RSITimerTest::sideEffectFreeQueries()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer timer(std::move(idle_time), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+
+    setTimerIdleState(timer, 0);
+    clock->advance(1000);
+    timer.onTickTimer();
+    const qint64 lastTickMs = timer.m_lastTickMs;
+
+    // The seconds since the last tick are counted, but not applied.
+    clock->advance(5 * 1000);
+    QCOMPARE(timer.tinyLeftNow(), m_intervals[TINY_BREAK_INTERVAL] - 6);
+    QCOMPARE(timer.bigLeftNow(), m_intervals[BIG_BREAK_INTERVAL] - 6);
+    QCOMPARE(timer.tinyLeft(), m_intervals[TINY_BREAK_INTERVAL] - 1);
+    QCOMPARE(timer.m_lastTickMs, lastTickMs);
+
+    // Idling past the threshold resets, in the projection only.
+    setTimerIdleState(timer, 1);
+    clock->advance(m_intervals[TINY_BREAK_THRESHOLD] * 1000);
+    QCOMPARE(timer.tinyLeftNow(), m_intervals[TINY_BREAK_INTERVAL]);
+    QVERIFY(!timer.tierCounter(RSITimer::TINY_TIER)->isReset());
+    QCOMPARE(timer.idleTime(), m_intervals[TINY_BREAK_THRESHOLD] + 1);
+
+    // Queries do not notice a suspend, so the next tick still does.
+    setTimerIdleState(timer, 0);
+    clock->suspend(120 * 1000);
+    QCOMPARE(timer.tinyLeftNow(), m_intervals[TINY_BREAK_INTERVAL] - 66);
+    timer.onTickTimer();
+    QCOMPARE(timer.bigLeft(), m_intervals[BIG_BREAK_INTERVAL] - 65);
+
+    // A break due by now leaves nothing, not the next interval.
+    clock->advance((m_intervals[TINY_BREAK_INTERVAL] + 5) * 1000LL);
+    QCOMPARE(timer.tinyLeftNow(), 0);
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Monitoring);
+}
+
+void RSITimerTest::bulkCatchUp()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSIClockFake *clock = new RSIClockFake();
+    RSITimer bulk(std::move(idle_time), m_intervals, true, true, std::unique_ptr<RSIClock>(clock));
+    RSITimer stepped(std::unique_ptr<RSIIdleTime>(new RSIIdleTimeFake()), m_intervals, true, true);
+
+    // Work, then idle for a while, in one catch up each.
+    setTimerIdleState(bulk, 0);
+    setTimerIdleState(stepped, 0);
+    const int work = m_intervals[TINY_BREAK_INTERVAL] - 100;
+    clock->advance(work * 1000LL);
+    bulk.onTickTimer();
+    for (int i = 0; i < work; i++) {
+        stepped.timeout();
+    }
+    QCOMPARE(bulk.tinyLeft(), stepped.tinyLeft());
+    QCOMPARE(bulk.bigLeft(), stepped.bigLeft());
+
+    bulk.m_isIdle = true;
+    bulk.m_idleStartMs = clock->monotonicMSecs();
+    const int idle = m_intervals[BIG_BREAK_THRESHOLD] + 30;
+    clock->advance(idle * 1000LL);
+    bulk.onTickTimer();
+    for (int i = 0; i < idle; i++) {
+        setTimerIdleState(stepped, i + 1);
+        stepped.timeout();
+    }
+    QCOMPARE(bulk.tinyLeft(), stepped.tinyLeft());
+    QCOMPARE(bulk.bigLeft(), stepped.bigLeft());
+    QVERIFY(bulk.tierCounter(RSITimer::BIG_TIER)->isReset());
+
+    // Back to work until the break is suggested, in the middle of a catch up.
+    bulk.m_isIdle = false;
+    setTimerIdleState(stepped, 0);
+    const int more = m_intervals[TINY_BREAK_INTERVAL] + 5;
+    clock->advance(more * 1000LL);
+    bulk.onTickTimer();
+    for (int i = 0; i < more; i++) {
+        stepped.timeout();
+    }
+    QCOMPARE(bulk.m_state, RSITimer::TimerState::Suggesting);
+    QCOMPARE(bulk.m_state, stepped.m_state);
+    QCOMPARE(bulk.bigLeft(), stepped.bigLeft());
+
+    // Idle through the suggested break, in one catch up as well.
+    bulk.m_isIdle = true;
+    bulk.m_idleStartMs = clock->monotonicMSecs();
+    const int rest = m_intervals[TINY_BREAK_DURATION] + 10;
+    clock->advance(rest * 1000LL);
+    bulk.onTickTimer();
+    for (int i = 0; i < rest; i++) {
+        setTimerIdleState(stepped, i + 1);
+        stepped.timeout();
+    }
+    QCOMPARE(bulk.m_state, RSITimer::TimerState::Monitoring);
+    QCOMPARE(bulk.m_state, stepped.m_state);
+    QCOMPARE(bulk.tinyLeft(), stepped.tinyLeft());
+    QCOMPARE(bulk.bigLeft(), stepped.bigLeft());
+}
+
+void RSITimerTest::extraTiers()
+{
+    // A micro pause every five minutes, and a lunch reminder.
+    QVector<int> intervals = m_intervals;
+    intervals << 5 * 60 << 10 << 5;
+    intervals << 4 * 60 * 60 << 30 * 60 << 20 * 60;
+    QCOMPARE(RSIGlobals::tierCount(intervals), 4);
+
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSITimer timer(std::move(idle_time), intervals, true, true);
+    QCOMPARE((int)timer.m_breakTiers.size(), 4);
+    QVERIFY(!timer.m_breakTiers[2].isLong);
+    QVERIFY(timer.m_breakTiers[3].isLong);
+
+    QSignalSpy spyRelax(&timer, SIGNAL(relax(int, bool)));
+    QSignalSpy spyEndShortBreak(&timer, SIGNAL(endShortBreak()));
+
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < 5 * 60; i++) {
+        QCOMPARE(timer.m_state, RSITimer::TimerState::Monitoring);
+        timer.timeout();
+    }
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+    QCOMPARE(spyRelax.count(), 1);
+    QCOMPARE(spyRelax.takeFirst().at(0).toInt(), 10);
+
+    for (int i = 0; i < 10; i++) {
+        setTimerIdleState(timer, i + 1);
+        timer.timeout();
+    }
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Monitoring);
+    QCOMPARE(spyEndShortBreak.count(), 1);
+
+    // Only the micro pause counter starts over after its break.
+    QCOMPARE(timer.tierCounter(2)->counterLeft(), 5 * 60);
+    QVERIFY(timer.tierCounter(RSITimer::TINY_TIER)->counterLeft() < m_intervals[TINY_BREAK_INTERVAL]);
+    QVERIFY(timer.tierCounter(3)->counterLeft() < 4 * 60 * 60);
+}
+
+void RSITimerTest::allocationFreeBreaks()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSITimer timer(std::move(idle_time), m_intervals, true, true);
+
+    // Nothing in here may allocate, QCOMPARE included, so the states seen
+    // are only checked afterwards.
+    const int maxTicks = m_intervals[BIG_BREAK_INTERVAL] + m_intervals[PATIENCE_INTERVAL] + m_intervals[BIG_BREAK_DURATION];
+    auto tickWhile = [this, &timer, maxTicks](const RSITimer::TimerState state, const bool idle) {
+        for (int i = 0; i < maxTicks && timer.m_state == state; ++i) {
+            setTimerIdleState(timer, idle ? i + 1 : 0);
+            timer.timeout();
+        }
+        return timer.m_state;
+    };
+    // Works until a break, then idles through it or works through the
+    // patience and waits out the rest.
+    auto breakCycle = [&tickWhile](const bool idleThrough, RSITimer::TimerState *states) {
+        states[0] = tickWhile(RSITimer::TimerState::Monitoring, false);
+        if (idleThrough) {
+            states[1] = RSITimer::TimerState::Resting;
+            states[2] = tickWhile(RSITimer::TimerState::Suggesting, true);
+        } else {
+            states[1] = tickWhile(RSITimer::TimerState::Suggesting, false);
+            states[2] = tickWhile(RSITimer::TimerState::Resting, false);
+        }
+    };
+
+    // The first break sets up the statistics and whatever Qt caches.
+    RSITimer::TimerState warmUp[3];
+    breakCycle(true, warmUp);
+    breakCycle(false, warmUp);
+
+    RSITimer::TimerState idleCycle[3];
+    RSITimer::TimerState workCycle[3];
+    AllocationCounter::start();
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < 60; i++) {
+        timer.timeout();
+    }
+    breakCycle(true, idleCycle);
+    breakCycle(false, workCycle);
+    const int allocations = AllocationCounter::stop();
+
+    QCOMPARE(idleCycle[0], RSITimer::TimerState::Suggesting);
+    QCOMPARE(idleCycle[2], RSITimer::TimerState::Monitoring);
+    QCOMPARE(workCycle[0], RSITimer::TimerState::Suggesting);
+    QCOMPARE(workCycle[1], RSITimer::TimerState::Resting);
+    QCOMPARE(workCycle[2], RSITimer::TimerState::Monitoring);
+    QCOMPARE(allocations, 0);
+}
+
+void RSITimerTest::snapshotCoalescing()
+{
+    std::unique_ptr<RSIIdleTimeFake> idle_time(new RSIIdleTimeFake());
+    RSITimer timer(std::move(idle_time), m_intervals, true, true);
+
+    QSignalSpy spySnapshot(&timer, &RSITimer::snapshotChanged);
+    QSignalSpy spyToolTip(&timer, &RSITimer::updateToolTip);
+
+    // Active with less than an hour left, the tooltip changes every second.
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < 10; i++) {
+        timer.timeout();
+    }
+    QCOMPARE(spySnapshot.count(), 10);
+    QCOMPARE(timer.snapshot().tinyLeft, m_intervals[TINY_BREAK_INTERVAL] - 10);
+    QCOMPARE(timer.snapshot().relaxLeft, -1);
+
+    // Idle past both thresholds the counters reset once and then stay.
+    spySnapshot.clear();
+    spyToolTip.clear();
+    for (int i = 0; i < 10; i++) {
+        setTimerIdleState(timer, m_intervals[BIG_BREAK_THRESHOLD] + i);
+        timer.timeout();
+    }
+    QCOMPARE(spyToolTip.count(), 10);
+    QCOMPARE(spySnapshot.count(), 1);
+    QCOMPARE(timer.snapshot().bigLeft, m_intervals[BIG_BREAK_INTERVAL]);
+    QCOMPARE(timer.snapshot().idleSeconds, m_intervals[BIG_BREAK_THRESHOLD]);
+
+    // Suggesting a break, the popup counts down.
+    setTimerIdleState(timer, 0);
+    for (int i = 0; i < m_intervals[TINY_BREAK_INTERVAL]; i++) {
+        timer.timeout();
+    }
+    QCOMPARE(timer.m_state, RSITimer::TimerState::Suggesting);
+    QCOMPARE(timer.snapshot().state, (int)RSITimer::TimerState::Suggesting);
+    QCOMPARE(timer.snapshot().relaxLeft, m_intervals[TINY_BREAK_DURATION]);
+    QCOMPARE(timer.snapshot().breakLeft, m_intervals[TINY_BREAK_DURATION]);
+    QCOMPARE(timer.snapshot().nextBreakIsBig, false);
+
+    // Working on through the suggestion runs out the patience, one snapshot per tick.
+    spySnapshot.clear();
+    timer.timeout();
+    QCOMPARE(spySnapshot.count(), 1);
+    QCOMPARE(timer.snapshot().patienceLeft, m_intervals[PATIENCE_INTERVAL] - 1);
+
+    // Suspended there is nothing more to show.
+    timer.slotStop();
+    QCOMPARE(timer.snapshot().state, (int)RSITimer::TimerState::Suspended);
+    QCOMPARE(timer.snapshot().iconLevel, 0);
+    spySnapshot.clear();
+    timer.timeout();
+    QCOMPARE(spySnapshot.count(), 0);
+}
@@ -27,6 +27,18 @@ private slots:
     void skipBreak();
     void noPopupBreak();
     void regularBreaks();
+    void deadlinePlanning();
+    void thresholdTimeouts();
+    void breakWhileIdle();
+    void inputIntensity();
+    void catchUpAfterStall();
+    void catchUpLogTimes();
+    void suspendResetsCounters();
+    void sideEffectFreeQueries();
+    void bulkCatchUp();
+    void extraTiers();
+    void allocationFreeBreaks();
+    void snapshotCoalescing();
 
 private:
     void setTimerIdleState(RSITimer &timer, int idleSeconds);
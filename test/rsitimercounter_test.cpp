@@ -6,6 +6,8 @@
 
 #include "rsitimercounter.h"
 
+#include <QRandomGenerator>
+
 static constexpr int TEST_DELAY = 15 * 60;
 static constexpr int TEST_THRESHOLD = 40;
 static constexpr int TEST_BREAK = 30;
@@ -67,3 +69,75 @@ void RSITimerCounterTest::mixedCountdown()
     QCOMPARE(breakInterval, 0);
     QVERIFY2(counter.isReset(), QString("Counter is not reset after %1 ticks").arg(TEST_DELAY).toLatin1());
 }
+
+void RSITimerCounterTest::bulkAdvance()
+{
+    // advance() has to end up exactly where the same number of tick() calls does.
+    QRandomGenerator random(42);
+    for (int run = 0; run < 100000; run++) {
+        const int delay = random.bounded(12);
+        const int threshold = random.bounded(8) == 0 ? INT_MAX : random.bounded(10);
+        RSITimerCounter stepped = RSITimerCounter(delay, TEST_BREAK, threshold);
+        RSITimerCounter bulk = RSITimerCounter(delay, TEST_BREAK, threshold);
+
+        const int warmup = random.bounded(15);
+        for (int i = 0; i < warmup; i++) {
+            const int idleTime = random.bounded(3) == 0 ? random.bounded(12) : 0;
+            stepped.tick(idleTime);
+            bulk.tick(idleTime);
+        }
+
+        const int ticks = random.bounded(40);
+        const int idleTime = random.bounded(2) ? random.bounded(12) : 0;
+        const bool idleGrows = random.bounded(2);
+        const int ticksToBreak = bulk.ticksToBreak(idleTime, idleGrows);
+
+        int breaks = 0;
+        int firstBreak = INT_MAX;
+        for (int i = 0; i < ticks; i++) {
+            if (stepped.tick(idleGrows ? idleTime + i : idleTime) > 0) {
+                breaks++;
+                firstBreak = std::min(firstBreak, i + 1);
+            }
+        }
+
+        QCOMPARE(bulk.advance(ticks, idleTime, idleGrows), breaks);
+        QCOMPARE(bulk.counterLeft(), stepped.counterLeft());
+        QCOMPARE(bulk.isReset(), stepped.isReset());
+        if (firstBreak != INT_MAX) {
+            QCOMPARE(ticksToBreak, firstBreak);
+        } else {
+            QVERIFY(ticksToBreak > ticks);
+        }
+    }
+
+    // A whole year of activity in one step.
+    RSITimerCounter counter = RSITimerCounter(TEST_DELAY, TEST_BREAK, TEST_THRESHOLD);
+    static constexpr int YEAR = 365 * 24 * 60 * 60;
+    QCOMPARE(counter.advance(YEAR, 0, false), YEAR / TEST_DELAY);
+    QCOMPARE(counter.counterLeft(), TEST_DELAY - YEAR % TEST_DELAY);
+}
+
+void RSITimerCounterTest::extraLoad()
+{
+    RSITimerCounter counter = RSITimerCounter(TEST_DELAY, TEST_BREAK, TEST_THRESHOLD);
+
+    // Nothing to add to while reset.
+    counter.addLoad(10);
+    QVERIFY(counter.isReset());
+
+    QCOMPARE(counter.tick(0), 0);
+    counter.addLoad(10);
+    QCOMPARE(counter.counterLeft(), TEST_DELAY - 11);
+
+    // Taking load back never resets.
+    counter.addLoad(-100);
+    QCOMPARE(counter.counterLeft(), TEST_DELAY - 1);
+    QVERIFY(!counter.isReset());
+
+    // Nor does adding it make the break due, the next tick does.
+    counter.addLoad(TEST_DELAY * 2);
+    QCOMPARE(counter.counterLeft(), 1);
+    QCOMPARE(counter.tick(0), TEST_BREAK);
+    QVERIFY(counter.isReset());
+}
@@ -16,6 +16,8 @@ private slots:
     void normalCountdown();
     void thresholdReached();
     void mixedCountdown();
+    void bulkAdvance();
+    void extraLoad();
 };
 
 #endif // RSIBREAK_RSITIMERCOUNTER_TEST_H
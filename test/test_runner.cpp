@@ -5,6 +5,15 @@
 #include <QTest>
 #include <memory>
 
+#include "rsiactivityheatmap_test.h"
+#include "rsiactivityhistory_test.h"
+#include "rsiactivitylog_test.h"
+#include "rsiexporter_test.h"
+#include "rsihistory_test.h"
+#include "rsiidletime_test.h"
+#include "rsiidletrace_test.h"
+#include "rsistatsmodel_test.h"
+#include "rsisuppressionmonitor_test.h"
 #include "rsitimer_test.h"
 #include "rsitimercounter_test.h"
 
@@ -15,6 +24,15 @@ int main(int argc, char *argv[])
     std::vector<std::unique_ptr<QObject>> tests;
     tests.emplace_back(new RSITimerCounterTest());
     tests.emplace_back(new RSITimerTest());
+    tests.emplace_back(new RSIActivityHistoryTest());
+    tests.emplace_back(new RSIActivityLogTest());
+    tests.emplace_back(new RSIActivityHeatmapTest());
+    tests.emplace_back(new RSIHistoryTest());
+    tests.emplace_back(new RSIExporterTest());
+    tests.emplace_back(new RSIStatsModelTest());
+    tests.emplace_back(new RSIIdleTimeTest());
+    tests.emplace_back(new RSIIdleTraceTest());
+    tests.emplace_back(new RSISuppressionMonitorTest());
 
     int status = 0;
     for (auto &test : tests) {